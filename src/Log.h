@@ -10,6 +10,8 @@
 #include <atomic>
 #include <limits>
 #include <array>
+#include <optional>
+#include <utility>
 
 namespace nowtech::log {
 
@@ -66,7 +68,25 @@ public:
   }
 };
 
-template<bool tAllowRegistrationLog, LogTopic tMaxTopicCount, TaskRepresentation tTaskRepresentation, size_t tDirectBufferSize, int32_t tRefreshPeriod, ErrorLevel tErrorLevel = ErrorLevel::All>
+/// Tells if a sender has the optional flush() which Log calls when the transmitter idles.
+template<typename tSender, typename = void>
+struct SenderFlushes : std::false_type {
+};
+
+template<typename tSender>
+struct SenderFlushes<tSender, std::void_t<decltype(tSender::flush())>> : std::true_type {
+};
+
+/// The same for the senders of QueueSharded, which flush the sender of one shard.
+template<typename tSender, typename = void>
+struct SenderFlushesShard : std::false_type {
+};
+
+template<typename tSender>
+struct SenderFlushesShard<tSender, std::void_t<decltype(tSender::flush(size_t{}))>> : std::true_type {
+};
+
+template<bool tAllowRegistrationLog, LogTopic tMaxTopicCount, TaskRepresentation tTaskRepresentation, size_t tDirectBufferSize, int32_t tRefreshPeriod, ErrorLevel tErrorLevel = ErrorLevel::All, size_t tTransmitBatchSize = 8u, size_t tGroupStagingSize = 0u, size_t tReassemblyInlineSize = 8u, int32_t tLossReportPeriod = 0, int32_t tPartialGroupTimeout = 0, size_t tPoolSoftQuota = 0u, size_t tPoolHardQuota = 0u, size_t tPoolReserve = 0u, size_t tCoalesceHeadroom = 0u, int32_t tCoalesceLatency = 0>
 struct Config final {
 public:
   static constexpr bool               csAllowRegistrationLog = tAllowRegistrationLog;
@@ -75,6 +95,16 @@ public:
   static constexpr size_t             csDirectBufferSize     = tDirectBufferSize;
   static constexpr int32_t            csRefreshPeriod        = tRefreshPeriod; // Can represent 1s even if the unit is ns.
   static constexpr ErrorLevel         csErrorLevel           = tErrorLevel;
+  static constexpr size_t             csTransmitBatchSize    = tTransmitBatchSize; // Messages on the transmitter stack popped at once.
+  static constexpr size_t             csGroupStagingSize     = tGroupStagingSize;  // Messages of a group collected for one pushBatch, 0 pushes each at once.
+  static constexpr size_t             csReassemblyInlineSize = tReassemblyInlineSize; // Messages of a partial group kept per task in a flat array.
+  static constexpr int32_t            csLossReportPeriod     = tLossReportPeriod;     // Minimum time between lost group lines, 0 for none.
+  static constexpr int32_t            csPartialGroupTimeout  = tPartialGroupTimeout;  // Age of a partial group when it is flushed as truncated, 0 for never.
+  static constexpr size_t             csPoolSoftQuota        = tPoolSoftQuota;        // Pool nodes a task may use without borrowing, 0 for the whole pool.
+  static constexpr size_t             csPoolHardQuota        = tPoolHardQuota;        // Pool nodes a task may never exceed, 0 for the whole pool.
+  static constexpr size_t             csPoolReserve          = tPoolReserve;          // Pool nodes only Fatal and Error groups may take.
+  static constexpr size_t             csCoalesceHeadroom     = tCoalesceHeadroom;     // Lines are collected in the sender buffer while this much is left, 0 sends each at once.
+  static constexpr int32_t            csCoalesceLatency      = tCoalesceLatency;      // Maximum age of collected lines under continuous load, 0 for no limit.
 };
 
 struct LogFormatConfig final {
@@ -92,6 +122,12 @@ public:
   inline static constexpr LogFormat B24     { 2u, 24u};
   inline static constexpr LogFormat B32     { 2u, 32u};
   inline static constexpr LogFormat Fm      {10u,  0u}; // for maximum precision in floating-point types
+  inline static constexpr LogFormat Fs      {10u, LogFormat::csFillValueShortest}; // shortest exact float or double, if the converter supports it
+  inline static constexpr LogFormat F1      {10u, LogFormat::csFillValueFixed + 1u}; // fixed notation with this many decimals, scientific if too large
+  inline static constexpr LogFormat F2      {10u, LogFormat::csFillValueFixed + 2u};
+  inline static constexpr LogFormat F3      {10u, LogFormat::csFillValueFixed + 3u};
+  inline static constexpr LogFormat F4      {10u, LogFormat::csFillValueFixed + 4u};
+  inline static constexpr LogFormat F6      {10u, LogFormat::csFillValueFixed + 6u};
   inline static constexpr LogFormat D1      {10u,  1u};
   inline static constexpr LogFormat D2      {10u,  2u};
   inline static constexpr LogFormat D3      {10u,  3u};
@@ -151,7 +187,28 @@ private:
   static constexpr size_t   csPayloadSizeBr            = tMessage::csPayloadSize;
   static constexpr size_t   csPayloadSizeNet           = tMessage::csPayloadSize - 1u;  // we leave space for terminal 0 to avoid counting bytes
   static constexpr int32_t  csRefreshPeriod            = tLogConfig::csRefreshPeriod;
+  static constexpr size_t   csTransmitBatchSize        = tLogConfig::csTransmitBatchSize;
+  static constexpr size_t   csReassemblyInlineSize     = tLogConfig::csReassemblyInlineSize;
+  static constexpr LogTime  csLossReportPeriod         = static_cast<LogTime>(tLogConfig::csLossReportPeriod);
+  static constexpr LogTime  csPartialGroupTimeout      = static_cast<LogTime>(tLogConfig::csPartialGroupTimeout);
+  static constexpr LogTime  csEvictionCheckPeriod      = std::max<LogTime>(csPartialGroupTimeout / 2, 1);  // So a group lives at most 1.5 times the timeout.
+  // Wakeable queues let the idle transmitter sleep until Log::done or sendAtomicBuffer wakes it.
+  static constexpr LogTime  csIdlePauseLength          = tQueue::csWakeable ? std::numeric_limits<LogTime>::max() : static_cast<LogTime>(csRefreshPeriod);
+  // Stale groups must be evicted even if nothing else arrives.
+  static constexpr LogTime  csTransmitPauseLength      = csPartialGroupTimeout > 0 ? std::min(csIdlePauseLength, csEvictionCheckPeriod) : csIdlePauseLength;
   static constexpr size_t   csQueueSize                = tQueue::csQueueSize;
+  static constexpr size_t   csPoolSoftQuota            = tLogConfig::csPoolSoftQuota == 0u ? csQueueSize : tLogConfig::csPoolSoftQuota;
+  static constexpr size_t   csPoolHardQuota            = tLogConfig::csPoolHardQuota == 0u ? csQueueSize : tLogConfig::csPoolHardQuota;
+  static constexpr size_t   csPoolReserve              = tLogConfig::csPoolReserve;
+  static constexpr size_t   csCoalesceHeadroom         = tLogConfig::csCoalesceHeadroom;
+  static constexpr bool     csCoalesce                 = csCoalesceHeadroom > 0u;
+  static constexpr LogTime  csCoalesceLatency          = static_cast<LogTime>(tLogConfig::csCoalesceLatency);
+  static constexpr bool     csGroupCommit              = tQueue::csGroupCommit;  // The queue takes and gives whole groups.
+  static constexpr size_t   csShardCount               = tQueue::csShardCount;   // Each shard has its own transmitter task.
+  // Batching senders submit when the transmitter idles.
+  static constexpr bool     csSenderFlushes            = csShardCount == 1u ? SenderFlushes<tSender>::value : SenderFlushesShard<tSender>::value;
+  static constexpr size_t   csPushStagingSize          = csGroupCommit ? 0u : tLogConfig::csGroupStagingSize;
+  static constexpr bool     csStagedPush               = csPushStagingSize > 0u;  // Messages go in with pushBatch.
   static constexpr TaskId   csInvalidTaskId            = tAppInterface::csInvalidTaskId;
   static constexpr TaskId   csIsrTaskId                = tAppInterface::csIsrTaskId;
   static constexpr TaskId   csMaxTaskCount             = tAppInterface::csMaxTaskCount;
@@ -169,38 +226,199 @@ private:
   static constexpr MessageSequence csSequence1  = 1u;
   static constexpr char csTerminalChar          = 0;
 
+  static constexpr size_t getGroupStagingSize() noexcept {
+    if constexpr(csGroupCommit) {
+      return tQueue::csMaxGroupSize;
+    }
+    else if constexpr(csStagedPush) {
+      return csPushStagingSize + 2u;   // The message with sequence 0, the staged ones and room to append the former.
+    }
+    else {
+      return 1u;   // Only the message with sequence 0 is held back.
+    }
+  }
+
+  static constexpr size_t csGroupStagingSize = getGroupStagingSize();
+
+  static constexpr bool hasMatchingSenderShards() noexcept {
+    if constexpr(csShardCount == 1u) {
+      return true;
+    }
+    else {
+      return tSender::csShardCount == csShardCount;   // SenderShared or SenderPerShard
+    }
+  }
+
   using Occupier = typename tAppInterface::Occupier;
   using Allocator = memory::PoolAllocator<tMessage, Occupier>;
   using MessageQueue = std::list<tMessage, Allocator>;
-  using MessageQueueArray = std::array<MessageQueue*, csMaxTotalTaskCount>; // Need the indirection to be able use allocator in constructor call.
-  // Could introduce a new list type but the performance gain would be less than a percent.
+
+  /// Partial group of a task, kept by the transmitter until its message with sequence 0
+  /// arrives. That one is not stored, as it is output first right when it arrives.
+  /// Appending is an index bump while the inline array lasts, longer groups continue
+  /// in a list taking its nodes from the pool of the shard, within the quotas of the task.
+  class PendingGroup final {
+    std::array<tMessage, csReassemblyInlineSize> mInline;
+    size_t          mInlineCount;
+    MessageQueue    mOverflow;
+    size_t         &mPoolUsage;     // Nodes taken from the pool by all the groups of the shard.
+    MessageSequence mLastSequence;
+    LogTime         mStarted;       // Transmitter time of the batch bringing the first stored message.
+
+  public:
+    PendingGroup(Allocator &aAllocator, size_t &aPoolUsage) noexcept
+      : mInlineCount(0u)
+      , mOverflow(aAllocator)
+      , mPoolUsage(aPoolUsage)
+      , mLastSequence(csSequence0)
+      , mStarted(0) {
+    }
+
+    bool empty() const noexcept {
+      return mInlineCount == 0u && mOverflow.empty();
+    }
+
+    size_t size() const noexcept {
+      return mInlineCount + mOverflow.size();
+    }
+
+    MessageSequence getLastSequence() const noexcept {
+      return mLastSequence;
+    }
+
+    LogTime getStarted() const noexcept {
+      return mStarted;
+    }
+
+    /// @return false if the message would need a list node but the pool is exhausted or the quota is over.
+    bool append(tMessage const &aMessage, Allocator &aPool, LogTime const aNow) noexcept {
+      bool result = true;
+      if(empty()) {
+        mStarted = aNow;
+      }
+      else { // nothing to do
+      }
+      if(mInlineCount < csReassemblyInlineSize) {
+        mInline[mInlineCount] = aMessage;
+        ++mInlineCount;
+      }
+      else if(mayTakeNode(aMessage.isPriority()) && aPool.hasFree()) {
+        mOverflow.push_back(aMessage);
+        ++mPoolUsage;
+      }
+      else {
+        result = false;
+      }
+      if(result) {
+        mLastSequence = aMessage.getMessageSequence();
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
+
+    void output(tConverter &aConverter) const noexcept {
+      for(size_t i = 0u; i < mInlineCount; ++i) {
+        mInline[i].template output<tConverter>(aConverter);
+      }
+      for(auto &message : mOverflow) {
+        message.template output<tConverter>(aConverter);
+      }
+    }
+
+    void clear() noexcept {
+      mPoolUsage -= mOverflow.size();
+      mInlineCount = 0u;
+      mOverflow.clear();
+    }
+
+  private:
+    /// Below the soft quota a group may use the pool except the reserve. Above it, it may only
+    /// borrow while a soft quota worth of nodes remains for the others. Fatal and Error groups
+    /// may also take the reserve.
+    bool mayTakeNode(bool const aPriority) const noexcept {
+      size_t const used = mOverflow.size();
+      size_t const free = csQueueSize - mPoolUsage;
+      bool result;
+      if(used >= csPoolHardQuota) {
+        result = false;
+      }
+      else if(aPriority) {
+        result = free > 0u;
+      }
+      else if(used < csPoolSoftQuota) {
+        result = free > csPoolReserve;
+      }
+      else {
+        result = free > csPoolReserve + csPoolSoftQuota;
+      }
+      return result;
+    }
+  };
+
+  /// Written by producers and transmitters, so relaxed atomics. mReportedGroups belongs to the transmitter.
+  struct TaskLosses final {
+    std::atomic<uint32_t> mRejectedMessages;
+    std::atomic<uint32_t> mRejectedGroups;
+    std::atomic<uint32_t> mDiscardedMessages;
+    std::atomic<uint32_t> mDiscardedGroups;
+    uint32_t              mReportedGroups;
+  };
+
+  using PendingGroupArray = std::array<PendingGroup*, csMaxTotalTaskCount>; // Need the indirection to be able use allocator in constructor call.
   using TaskShutdownArray = std::array<std::atomic<bool>, csMaxTotalTaskCount>;
+  using GroupDiscardingArray = std::array<bool, csMaxTotalTaskCount>;  // Only the transmitter task uses it.
 
   static_assert(csPayloadSizeNet > 0u);
+  static_assert(csTransmitBatchSize > 0u);
+  static_assert(!csStagedPush || csPushStagingSize < csQueueSize);
+  static_assert(csPoolSoftQuota <= csPoolHardQuota && csPoolHardQuota <= csQueueSize);
+  static_assert(csPoolReserve == 0u || csPoolReserve < csQueueSize);
   static_assert(csInvalidTaskId == std::numeric_limits<TaskId>::max());
   static_assert(csIsrTaskId == std::numeric_limits<TaskId>::min());
   static_assert(csMaxTaskCount < std::numeric_limits<TaskId>::max());
   static_assert(std::is_same_v<tAppInterface, typename tQueue::tAppInterface_>);
+  static_assert(hasMatchingSenderShards());
   static_assert(std::is_same_v<tMessage, typename tConverter::tMessage_>);
+  static_assert(csSendInBackground || !tConverter::csWholeLines);   // Direct sending converts each value apart.
   static_assert(std::is_integral_v<tAtomicBufferType>);
   static_assert(csAtomicBufferSizeExponent <= csMaxAtomicBufferSizeExp);
 
   inline static constexpr char csRegisteredTask[]    = ">>> Registered task:";
   inline static constexpr char csUnregisteredTask[]  = ">>> Unregistered task:";
+  inline static constexpr char csLostGroupsBegin[]   = "[";
+  inline static constexpr char csLostGroupsMiddle[]  = "groups lost on task";
+  inline static constexpr char csLostGroupsEnd[]     = "]";
+  inline static constexpr char csTruncatedGroup[]    = "[truncated group of task";
+
+  // The header fields are marked, so structured converters can tell them from the rest.
+  inline static constexpr LogFormat csTaskNameFormat       {10u, LogFormat::csFillValueTaskName};
+  inline static constexpr LogFormat csStoredTaskNameFormat {10u, LogFormat::csFillValueStoreTaskName};
+  inline static constexpr LogFormat csTopicFormat          {10u, LogFormat::csFillValueTopic};
 
   inline static LogFormatConfig const                 *sConfig;
   inline static std::atomic<LogTopic>                  sNextFreeTopic;
   inline static std::atomic<bool>                      sKeepAliveTask;
   inline static std::array<TopicName, csMaxTopicCount> sRegisteredTopics;
   inline static TaskShutdownArray                     *sTaskShutdowns;
+  inline static GroupDiscardingArray                  *sGroupDiscardings;
+  inline static std::array<TaskLosses, csMaxTotalTaskCount> sLosses;
+  inline static std::array<LogTime, csShardCount>      sLastLossReports;
+  inline static std::array<LogTime, csShardCount>      sBatchTimes;           // Only read when csPartialGroupTimeout > 0.
+  inline static std::array<typename tConverter::Iterator, csShardCount> sCoalescedEnds;   // End of the lines waiting in the sender buffer, nullptr if none.
+  inline static std::array<LogTime, csShardCount>      sCoalesceStarts;       // When the first waiting line was added.
+  inline static std::array<LogTime, csShardCount>      sLastEvictionChecks;
 
   inline static Occupier           sOccupier;
-  inline static Allocator         *sAllocator;
-  inline static MessageQueueArray *sMessageQueues;
+  inline static std::array<Allocator*, csShardCount> sAllocators;  // One for each transmitter, the pool is not thread-safe.
+  inline static std::array<size_t, csShardCount>     sPoolUsages;
+  inline static PendingGroupArray *sPendingGroups;
 
   Log() = delete;
 
   /// This will be used to send via queue. It stores the first message, and sends it only with the terminal marker.
+  /// With csStagedPush it collects the rest too, and pushes them with one pushBatch per csPushStagingSize messages.
+  /// Being a temporary, the helper and so its staging buffer belong to the calling thread.
   class LogShiftChainHelperBackgroundSend final {
   private:
     inline static constexpr char      csEmptyString[] = "";
@@ -209,24 +427,30 @@ private:
     TaskId          mTaskId;
     LogFormat       mNextFormat;
     MessageSequence mNextSequence;
-    tMessage        mFirstMessage;
-    bool            mWasMessage;
+    size_t          mStagedCount;  // Staged messages after the first one, only for csStagedPush.
+    bool            mPushedAny;    // If a rejected push was the first one, the transmitter never learns about the group.
+    bool            mRejected;     // After a rejected push the rest of the group is only counted.
+    bool            mPriority;     // Fatal or Error group, may use the reserved part of the reassembly pool.
+    std::array<tMessage, csGroupStagingSize> mStaged;  // The whole group for csGroupCommit, otherwise the first message and the staged ones.
 
   public:
     static constexpr LogShiftChainEndMarker end = LogShiftChainEndMarker::cEnd;
 
     LogShiftChainHelperBackgroundSend() noexcept = delete;
 
-    LogShiftChainHelperBackgroundSend(TaskId const aTaskId) noexcept
+    LogShiftChainHelperBackgroundSend(TaskId const aTaskId, bool const aPriority = false) noexcept
      : mTaskId(aTaskId)
      , mNextSequence(0u)
-     , mWasMessage(false) {
+     , mStagedCount(0u)
+     , mPushedAny(false)
+     , mRejected(false)
+     , mPriority(aPriority) {
       mNextFormat.invalidate();
     }
 
     /// Can be used in application code to eliminate further operator<< calls when the topic is disabled.
     bool isValid() const noexcept {
-      return mTaskId != csInvalidTaskId;
+      return mTaskId != csInvalidTaskId && !mRejected;
     }
 
     template<typename tValue>
@@ -261,13 +485,32 @@ private:
     }
 
     void operator<<(LogShiftChainEndMarker const) noexcept {
-      if(mTaskId != csInvalidTaskId) {
-        if(!mWasMessage) {
-          mFirstMessage.set(csEmptyString, csEmptyFormat, mTaskId, csSequence0);
+      if(mRejected) {
+        countRejected(1u);   // The first message, which was held back to go last.
+      }
+      else if(mTaskId != csInvalidTaskId) {
+        if(mNextSequence == csSequence0) {
+          mStaged[0].set(csEmptyString, csEmptyFormat, mTaskId, csSequence0);
+          ++mNextSequence;
         }
         else { // nothing to do
         }
-        tQueue::push(mFirstMessage);
+        if constexpr(csGroupCommit) {
+          size_t const count = std::min<size_t>(mNextSequence, csGroupStagingSize);
+          if(mNextSequence > count) {   // The queue can't take the tail, which never gets in.
+            countRejected(mNextSequence - count);
+          }
+          else { // nothing to do
+          }
+          countPush(tQueue::pushGroup(mStaged.data(), count), count);
+        }
+        else if constexpr(csStagedPush) {
+          mStaged[mStagedCount + 1u] = mStaged[0];
+          countPush(tQueue::pushBatch(mStaged.data() + 1u, mStagedCount + 1u), mStagedCount + 1u);
+        }
+        else {
+          countPush(tQueue::push(mStaged[0]), 1u);
+        }
       }
       else { // nothing to do
       }
@@ -289,8 +532,8 @@ private:
               ++copied;
             }
             payload[copied] = csTerminalChar;
-            if(*where == csTerminalChar) {
-              format.mFill = LogFormat::csFillValueStoreStringTerminal;
+            if(*where == csTerminalChar || isLastKept()) {
+              format.mFill = (format.mFill == LogFormat::csFillValueStoreTaskName) ? LogFormat::csFillValueTaskName : LogFormat::csFillValueStoreStringTerminal;
             }
             else { // nothing to do
             }
@@ -308,6 +551,11 @@ private:
       return *this;
     }
 
+    /// Queues with csGroupCommit take at most csGroupStagingSize messages, so a string cut there must end.
+    bool isLastKept() const noexcept {
+      return csGroupCommit && mNextSequence + 1u == csGroupStagingSize;
+    }
+
     LogFormat obtainFormat() noexcept {
       LogFormat result;
       if(mNextFormat.isValid()) {
@@ -320,16 +568,76 @@ private:
       return result;
     }
 
-    void sendOrStore(tMessage const & aMessage) noexcept {
-      if(mNextSequence == csSequence0) {
-        mWasMessage = true;
-        mFirstMessage = aMessage;
+    void sendOrStore(tMessage &aMessage) noexcept {
+      if(mPriority) {
+        aMessage.setPriority();
       }
-      else {
-        tQueue::push(aMessage);
+      else { // nothing to do
+      }
+      if(mRejected) {
+        countRejected(1u);
+      }
+      else if constexpr(csGroupCommit) {
+        if(mNextSequence < csGroupStagingSize) {
+          mStaged[mNextSequence] = aMessage;
+        }
+        else { // truncated, counted at the end
+        }
+      }
+      else if(mNextSequence == csSequence0) {
+        mStaged[0] = aMessage;
+      }
+      else if(!pushOrStage(aMessage)) {
+        // The transmitter would drop the group on the gap anyway, so the rest, including the
+        // first message, would only occupy queue slots. This makes isValid() return false.
+        mRejected = true;
+      }
+      else { // nothing to do
       }
       ++mNextSequence;
     }
+
+    bool pushOrStage(tMessage const & aMessage) noexcept {
+      bool result = true;
+      if constexpr(csStagedPush) {
+        if(mStagedCount == csPushStagingSize) {   // A long group goes in several batches, still with the first message last.
+          result = countPush(tQueue::pushBatch(mStaged.data() + 1u, mStagedCount), mStagedCount);
+          mStagedCount = 0u;
+        }
+        else { // nothing to do
+        }
+        if(result) {
+          ++mStagedCount;
+          mStaged[mStagedCount] = aMessage;
+        }
+        else {
+          countRejected(1u);   // It would have gone in the next batch.
+        }
+      }
+      else {
+        result = countPush(tQueue::push(aMessage), 1u);
+      }
+      return result;
+    }
+
+    bool countPush(bool const aSuccess, size_t const aCount) noexcept {
+      if(aSuccess) {
+        mPushedAny = true;
+      }
+      else {
+        countRejected(aCount);
+        if(!mPushedAny) {
+          sLosses[mTaskId].mRejectedGroups.fetch_add(1u, std::memory_order_relaxed);
+        }
+        else { // The transmitter will discard the beginning and count the group.
+        }
+      }
+      return aSuccess;
+    }
+
+    void countRejected(size_t const aCount) noexcept {
+      sLosses[mTaskId].mRejectedMessages.fetch_add(aCount, std::memory_order_relaxed);
+    }
   }; // class LogShiftChainHelperBackgroundSend
 
   /// This will be used to send directly, blocking the current thread.
@@ -340,7 +648,7 @@ private:
   public:
     LogShiftChainHelperDirectSend() noexcept = delete;
 
-    LogShiftChainHelperDirectSend(TaskId const aTaskId) noexcept
+    LogShiftChainHelperDirectSend(TaskId const aTaskId, bool const = false) noexcept
      : mTaskId(aTaskId) {
        mNextFormat.invalidate();
     }
@@ -400,7 +708,7 @@ private:
   public:
     LogShiftChainHelperEmpty() noexcept = delete;
 
-    LogShiftChainHelperEmpty(TaskId const) noexcept {
+    LogShiftChainHelperEmpty(TaskId const, bool const = false) noexcept {
     }
 
     /// Can be used in application code to eliminate further operator<< calls when the topic is disabled.
@@ -436,23 +744,50 @@ public:
   static constexpr ErrorLevel             debug = ErrorLevel::Debug;
   static constexpr ErrorLevel             all   = ErrorLevel::All;
 
+  /// Rejected messages were refused by a full queue, discarded ones got into the queue,
+  /// but the transmitter dropped them on a sequence gap or with the reassembly pool exhausted.
+  struct LossCounters final {
+    uint32_t rejectedMessages  = 0u;
+    uint32_t rejectedGroups    = 0u;
+    uint32_t discardedMessages = 0u;
+    uint32_t discardedGroups   = 0u;
+  };
+
+  struct Stats final {
+    LossCounters                                  total;
+    std::array<LossCounters, csMaxTotalTaskCount> tasks;  // Indexed by TaskId.
+  };
+
   template<typename ...tTypes>
   static void init(LogFormatConfig const &aConfig, tTypes... aArgs) {
     if constexpr(!csShutdownLog) {
       sConfig = &aConfig;
       if constexpr(csSendInBackground) {
-        std::byte experiment[sizeof(tMessage) + csListItemOverhead];
-        tMessage example;
-        size_t nodeSize = memory::AllocatorBlockGauge<std::list<tMessage>>::getNodeSize(experiment, example);
-        sAllocator = tAppInterface::template _new<Allocator>(csQueueSize, nodeSize, sOccupier);
-        sMessageQueues = tAppInterface::template _new<MessageQueueArray>();
-        sTaskShutdowns = tAppInterface::template _new<TaskShutdownArray>();
-        auto &messageQueues = *sMessageQueues;
-        for (size_t i = 0; i < csMaxTotalTaskCount; ++i) {
-          messageQueues[i] = tAppInterface::template _new<MessageQueue>(*sAllocator);
+        if constexpr(!csGroupCommit) {
+          std::byte experiment[sizeof(tMessage) + csListItemOverhead];
+          tMessage example;
+          size_t nodeSize = memory::AllocatorBlockGauge<std::list<tMessage>>::getNodeSize(experiment, example);
+          for(auto &allocator : sAllocators) {
+            allocator = tAppInterface::template _new<Allocator>(csQueueSize, nodeSize, sOccupier);
+          }
+          sPendingGroups = tAppInterface::template _new<PendingGroupArray>();
+          sGroupDiscardings = tAppInterface::template _new<GroupDiscardingArray>();
+          sGroupDiscardings->fill(false);
+          auto &pendingGroups = *sPendingGroups;
+          for (size_t i = 0; i < csMaxTotalTaskCount; ++i) {
+            pendingGroups[i] = tAppInterface::template _new<PendingGroup>(*sAllocators[getShard(i)], sPoolUsages[getShard(i)]);
+          }
         }
+        else { // nothing to do
+        }
+        sTaskShutdowns = tAppInterface::template _new<TaskShutdownArray>();
         sKeepAliveTask = true;
-        tAppInterface::init(transmitterTaskFunction, std::forward<tTypes>(aArgs)...);
+        if constexpr(csShardCount == 1u) {
+          tAppInterface::init(transmitterTaskFunction<0u>, std::forward<tTypes>(aArgs)...);
+        }
+        else {
+          initTransmitters(std::make_index_sequence<csShardCount>{}, std::forward<tTypes>(aArgs)...);
+        }
       } else {
         tAppInterface::init();
       }
@@ -470,14 +805,24 @@ public:
     if constexpr(!csShutdownLog) {
       if constexpr(csSendInBackground) {
         sKeepAliveTask = false;
-        tAppInterface::waitForFinished();
-        auto &messageQueues = *sMessageQueues;
-        for(size_t i = 0; i < csMaxTotalTaskCount; ++i) {
-          tAppInterface::template _delete<MessageQueue>(messageQueues[i]);
+        tQueue::wakeup();
+        for(size_t i = 0u; i < csShardCount; ++i) {
+          tAppInterface::waitForFinished();
+        }
+        if constexpr(!csGroupCommit) {
+          auto &pendingGroups = *sPendingGroups;
+          for(size_t i = 0; i < csMaxTotalTaskCount; ++i) {
+            tAppInterface::template _delete<PendingGroup>(pendingGroups[i]);
+          }
+          tAppInterface::template _delete<PendingGroupArray>(sPendingGroups);
+          tAppInterface::template _delete<GroupDiscardingArray>(sGroupDiscardings);
+          for(auto allocator : sAllocators) {
+            tAppInterface::template _delete<Allocator>(allocator);
+          }
+        }
+        else { // nothing to do
         }
-        tAppInterface::template _delete<MessageQueueArray>(sMessageQueues);
         tAppInterface::template _delete<TaskShutdownArray>(sTaskShutdowns);
-        tAppInterface::template _delete<Allocator>(sAllocator);
       }
       else { // nothing to do
       }
@@ -543,8 +888,10 @@ public:
       if constexpr(csSendInBackground) {
         tMessage message;
         message.setShutdown(taskId);
-        tQueue::push(message);
-        while(!(*sTaskShutdowns)[taskId]) {
+        while(!tQueue::push(message)) {  // Losing it would make us wait forever.
+          tAppInterface::sleepWhileWaitingForTaskShutdown();
+        }
+        while(!(*sTaskShutdowns)[taskId]) {   // Queues dropping the oldest message keep shutdown messages.
           tAppInterface::sleepWhileWaitingForTaskShutdown();
         }
       }
@@ -579,6 +926,24 @@ public:
     }
   }
 
+  /// The counters are read one by one, so a snapshot taken while logging may be slightly inconsistent.
+  static Stats stats() noexcept {
+    Stats result;
+    for(size_t i = 0u; i < csMaxTotalTaskCount; ++i) {
+      auto &losses = sLosses[i];
+      auto &task = result.tasks[i];
+      task.rejectedMessages  = losses.mRejectedMessages.load(std::memory_order_relaxed);
+      task.rejectedGroups    = losses.mRejectedGroups.load(std::memory_order_relaxed);
+      task.discardedMessages = losses.mDiscardedMessages.load(std::memory_order_relaxed);
+      task.discardedGroups   = losses.mDiscardedGroups.load(std::memory_order_relaxed);
+      result.total.rejectedMessages  += task.rejectedMessages;
+      result.total.rejectedGroups    += task.rejectedGroups;
+      result.total.discardedMessages += task.discardedMessages;
+      result.total.discardedGroups   += task.discardedGroups;
+    }
+    return result;
+  }
+
   static void pushAtomic(tAtomicBufferType const &aValue) noexcept {
     if constexpr(!csShutdownLog && csAtomicBufferOperational) {
       tAtomicBuffer::push(aValue);
@@ -591,6 +956,7 @@ public:
     if constexpr(!csShutdownLog && csAtomicBufferOperational) {
       if constexpr(csSendInBackground) {
         tAtomicBuffer::scheduleForSend();
+        tQueue::wakeup();
         tAppInterface::atomicBufferSendWait();
       } else {
         doSendAtomicBuffer();
@@ -604,7 +970,7 @@ public:
   static LogShiftChainHelperErrorLevel<tRequestedErrorLevel> i() noexcept {
     if constexpr(!csShutdownLog && csErrorLevel >= tRequestedErrorLevel) {
       TaskId const taskId = tAppInterface::getCurrentTaskId();
-      return sendHeader<LogShiftChainHelperErrorLevel<tRequestedErrorLevel>>(taskId);
+      return sendHeader<LogShiftChainHelperErrorLevel<tRequestedErrorLevel>>(taskId, isPriority(tRequestedErrorLevel));
     }
     else {
       return LogShiftChainHelperErrorLevel<tRequestedErrorLevel>{csInvalidTaskId};
@@ -614,7 +980,7 @@ public:
   template<ErrorLevel tRequestedErrorLevel = ErrorLevel::Off>
   static LogShiftChainHelperErrorLevel<tRequestedErrorLevel> i(TaskId const aTaskId) noexcept {
     if constexpr(!csShutdownLog && csErrorLevel >= tRequestedErrorLevel) {
-      return sendHeader<LogShiftChainHelperErrorLevel<tRequestedErrorLevel>>(aTaskId);
+      return sendHeader<LogShiftChainHelperErrorLevel<tRequestedErrorLevel>>(aTaskId, isPriority(tRequestedErrorLevel));
     }
     else {
       return LogShiftChainHelperErrorLevel<tRequestedErrorLevel>{csInvalidTaskId};
@@ -653,7 +1019,7 @@ public:
   template<ErrorLevel tRequestedErrorLevel = ErrorLevel::Off>
   static LogShiftChainHelperErrorLevel<tRequestedErrorLevel> n() noexcept {
     if constexpr(!csShutdownLog && csErrorLevel >= tRequestedErrorLevel) {
-      return LogShiftChainHelperErrorLevel<tRequestedErrorLevel>{tAppInterface::getCurrentTaskId()};
+      return LogShiftChainHelperErrorLevel<tRequestedErrorLevel>{tAppInterface::getCurrentTaskId(), isPriority(tRequestedErrorLevel)};
     }
     else {
       return LogShiftChainHelperErrorLevel<tRequestedErrorLevel>{csInvalidTaskId};
@@ -663,7 +1029,7 @@ public:
   template<ErrorLevel tRequestedErrorLevel = ErrorLevel::Off>
   static LogShiftChainHelperErrorLevel<tRequestedErrorLevel> n(TaskId const aTaskId) noexcept {
     if constexpr(!csShutdownLog && csErrorLevel >= tRequestedErrorLevel) {
-      return LogShiftChainHelperErrorLevel<tRequestedErrorLevel>{aTaskId};
+      return LogShiftChainHelperErrorLevel<tRequestedErrorLevel>{aTaskId, isPriority(tRequestedErrorLevel)};
     }
     else {
       return LogShiftChainHelperErrorLevel<tRequestedErrorLevel>{csInvalidTaskId};
@@ -709,25 +1075,29 @@ public:
   // }
 
 private:
+  static constexpr bool isPriority(ErrorLevel const aErrorLevel) noexcept {
+    return aErrorLevel == ErrorLevel::Fatal || aErrorLevel == ErrorLevel::Error;
+  }
+
   template <typename tLogShiftChainHelper>
-  static tLogShiftChainHelper sendHeader(TaskId const aTaskId) noexcept {
-    tLogShiftChainHelper result{aTaskId};
+  static tLogShiftChainHelper sendHeader(TaskId const aTaskId, bool const aPriority = false) noexcept {
+    tLogShiftChainHelper result{aTaskId, aPriority};
     if(result.isValid()) {
       if constexpr(csTaskRepresentation == TaskRepresentation::cId) {
-        result << sConfig->taskIdFormat << aTaskId;
+        result << sConfig->taskIdFormat.asTaskId() << aTaskId;
       }
       else if constexpr (csTaskRepresentation == TaskRepresentation::cName) {
         if constexpr (csConstantTaskNames || !csSendInBackground) {
-          result << tAppInterface::getTaskName(aTaskId);
+          result << csTaskNameFormat << tAppInterface::getTaskName(aTaskId);
         }
         else {
-          result << LogFormatConfig::St << tAppInterface::getTaskName(aTaskId);
+          result << csStoredTaskNameFormat << tAppInterface::getTaskName(aTaskId);
         }
       }
       else { // nothing to do
       }
       if (sConfig->tickFormat.isValid()) {
-        result << sConfig->tickFormat << tAppInterface::getLogTime();
+        result << sConfig->tickFormat.asTimestamp() << tAppInterface::getLogTime();
       }
       else { // nothing to do
       }
@@ -741,118 +1111,460 @@ private:
   static tLogShiftChainHelper sendHeader(TaskId const aTaskId, char const * aTopicName) noexcept {
     tLogShiftChainHelper result = sendHeader<tLogShiftChainHelper>(aTaskId);
     if(result.isValid() && aTopicName != nullptr) {
-      result << aTopicName;
+      result << csTopicFormat << aTopicName;
     }
     else { // nothing to do
     }
     return result;
   }
 
-  static void transmitterTaskFunction() noexcept {
-    while(sKeepAliveTask || !tQueue::empty()) {
-      tMessage message;
-      if(tQueue::pop(message, csRefreshPeriod)) {
-        TaskId taskId = message.getTaskId();
-        if (message.isShutdown()) {
-          (*sTaskShutdowns)[taskId] = true;
+  template<typename ...tTypes, size_t ...tShards>
+  static void initTransmitters(std::index_sequence<tShards...>, tTypes... aArgs) {
+    static constexpr std::array<void(*)(), csShardCount> csFunctions = { transmitterTaskFunction<tShards>... };
+    tAppInterface::init(csFunctions.data(), csShardCount, std::forward<tTypes>(aArgs)...);
+  }
+
+  static size_t getShard(TaskId const aTaskId) noexcept {
+    if constexpr(csShardCount == 1u) {
+      return 0u;
+    }
+    else {
+      return tQueue::getShard(aTaskId);
+    }
+  }
+
+  // Unsharded queues and senders have no shard parameter.
+  static bool isQueueEmpty(size_t const aShard) noexcept {
+    if constexpr(csShardCount == 1u) {
+      return tQueue::empty();
+    }
+    else {
+      return tQueue::empty(aShard);
+    }
+  }
+
+  static auto getSenderBuffer(size_t const aShard) {
+    if constexpr(csShardCount == 1u) {
+      return tSender::getBuffer();
+    }
+    else {
+      return tSender::getBuffer(aShard);
+    }
+  }
+
+  static void sendFromShard(char const * const aBegin, char const * const aEnd, size_t const aShard) {
+    if constexpr(csShardCount == 1u) {
+      tSender::send(aBegin, aEnd);
+    }
+    else {
+      tSender::send(aBegin, aEnd, aShard);
+    }
+  }
+
+  /// With coalescing the line goes after the ones waiting in the sender buffer.
+  static auto getLineBuffer(size_t const aShard) {
+    auto result = getSenderBuffer(aShard);
+    if constexpr(csCoalesce) {
+      if(sCoalescedEnds[aShard] != nullptr) {
+        result.first = sCoalescedEnds[aShard];
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// Lines are only added whole, and the buffer is sent when less than csCoalesceHeadroom
+  /// is left. A line leaving less than that after waiting ones may have been truncated, so
+  /// then only the waiting ones are sent, and false tells the caller to convert the line
+  /// again into the emptied buffer.
+  static bool commitLine(typename tConverter::Iterator const aBegin, typename tConverter::Iterator const aEnd, size_t const aShard) {
+    bool result = true;
+    if constexpr(csCoalesce) {
+      bool const full = static_cast<size_t>(getSenderBuffer(aShard).second - aEnd) < csCoalesceHeadroom;
+      if(full && sCoalescedEnds[aShard] != nullptr) {
+        flushCoalesced(aShard);
+        result = false;
+      }
+      else {
+        if(sCoalescedEnds[aShard] == nullptr && csCoalesceLatency > 0) {
+          sCoalesceStarts[aShard] = tAppInterface::getLogTime();
+        }
+        else { // nothing to do
+        }
+        sCoalescedEnds[aShard] = aEnd;
+        if(full) {
+          flushCoalesced(aShard);
+        }
+        else { // nothing to do
+        }
+      }
+    }
+    else {
+      sendFromShard(aBegin, aEnd, aShard);
+    }
+    return result;
+  }
+
+  static void flushCoalesced(size_t const aShard) {
+    if constexpr(csCoalesce) {
+      if(sCoalescedEnds[aShard] != nullptr) {
+        sendFromShard(getSenderBuffer(aShard).first, sCoalescedEnds[aShard], aShard);
+        sCoalescedEnds[aShard] = nullptr;
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Called after each round of the transmitter, so the lines wait only while more keep coming.
+  static void flushCoalescedIfDue(size_t const aShard) {
+    if constexpr(csCoalesce) {
+      if(sCoalescedEnds[aShard] != nullptr && (isQueueEmpty(aShard) ||
+         (csCoalesceLatency > 0 && tAppInterface::getLogTime() - sCoalesceStarts[aShard] >= csCoalesceLatency))) {
+        flushCoalesced(aShard);
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Senders having flush() may hold sent data back to submit it together, but not while the queue is empty.
+  static void flushSenderIfIdle(size_t const aShard) {
+    if constexpr(csSenderFlushes) {
+      if(isQueueEmpty(aShard)) {
+        if constexpr(csShardCount == 1u) {
+          tSender::flush();
         }
         else {
-          checkAndInsertAndTransmit(taskId, message);
+          tSender::flush(aShard);
         }
       }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Each shard has its own instance, the one of shard 0 also sends the atomic buffer.
+  template<size_t tShard>
+  static void transmitterTaskFunction() noexcept {
+    std::array<tMessage, csGroupCommit ? 0u : csTransmitBatchSize> messages;
+    while(sKeepAliveTask || !isQueueEmpty(tShard)) {
+      if constexpr(csGroupCommit) {
+        transmitGroup(tShard);
+      }
       else {
-        if constexpr(csAtomicBufferOperational) {
-          if(tAtomicBuffer::isScheduledForSent()) {
-            doSendAtomicBuffer();
-            tAppInterface::atomicBufferSendFinished();
-            tAtomicBuffer::sendFinished();
+        size_t count;
+        if constexpr(csShardCount == 1u) {
+          count = tQueue::popBatch(messages.data(), csTransmitBatchSize, csTransmitPauseLength);
+        }
+        else {
+          count = tQueue::popBatch(messages.data(), csTransmitBatchSize, csTransmitPauseLength, tShard);
+        }
+        if constexpr(csPartialGroupTimeout > 0) {
+          sBatchTimes[tShard] = tAppInterface::getLogTime();
+          evictStaleGroups(tShard);
+        }
+        else { // nothing to do
+        }
+        for(size_t i = 0u; i < count; ++i) {
+          TaskId taskId = messages[i].getTaskId();
+          if (messages[i].isShutdown()) {
+            discardPendingGroup(taskId);
+            (*sTaskShutdowns)[taskId] = true;
           }
-          else { // nothing to do
+          else {
+            checkAndInsertAndTransmit(taskId, messages[i], tShard);
           }
         }
+      }
+      if constexpr(csLossReportPeriod > 0) {
+        reportLosses(tShard, false);
+      }
+      else { // nothing to do
+      }
+      // Checked after every batch, because a wakeup may have been consumed together with messages.
+      if constexpr(csAtomicBufferOperational && tShard == 0u) {
+        if(tAtomicBuffer::isScheduledForSent()) {
+          doSendAtomicBuffer();
+          tAtomicBuffer::sendFinished();   // Before releasing the waiter, so its next schedule isn't cleared here.
+          tAppInterface::atomicBufferSendFinished();
+        }
         else { // nothing to do
         }
       }
+      else { // nothing to do
+      }
+      flushCoalescedIfDue(tShard);
+      flushSenderIfIdle(tShard);
     }
+    if constexpr(csLossReportPeriod > 0) {   // Losses of the last period would remain unnoticed otherwise.
+      reportLosses(tShard, true);
+    }
+    else { // nothing to do
+    }
+    flushCoalesced(tShard);
     tAppInterface::finish();
   }
 
-  static void checkAndInsertAndTransmit(TaskId const aTaskId, tMessage const &aMessage) noexcept {
-    auto list = (*sMessageQueues)[aTaskId];
-    bool ready = false;
+  /// The group arrives whole and in order, so it is converted right from the queue slots.
+  /// Variable-length queues hand over transient strings joined, others only messages.
+  /// The queue calls finish() after the group, and visits it again if that returns false.
+  struct GroupVisitor final {
+    size_t                        mShard;
+    typename tConverter::Iterator mBegin;
+    std::optional<tConverter>     mConverter;
+    bool                          mShutdown;
+
+    explicit GroupVisitor(size_t const aShard) noexcept
+    : mShard(aShard)
+    , mShutdown(false) {
+      start();
+    }
+
+    void operator()(tMessage const &aMessage) noexcept {
+      if(aMessage.isShutdown()) {
+        (*sTaskShutdowns)[aMessage.getTaskId()] = true;
+        mShutdown = true;
+      }
+      else {
+        aMessage.template output<tConverter>(*mConverter);
+      }
+    }
+
+    void operator()(char const * const aChars, uint8_t const aFill) noexcept {
+      mConverter->convert(aChars, aFill);
+    }
+
+    bool finish() noexcept {
+      bool result = true;
+      if(!mShutdown) {
+        mConverter->terminateSequence();
+        result = commitLine(mBegin, mConverter->end(), mShard);
+        if(!result) {
+          start();
+        }
+        else { // nothing to do
+        }
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
+
+  private:
+    void start() noexcept {
+      auto [begin, end] = getLineBuffer(mShard);
+      mBegin = begin;
+      mConverter.emplace(begin, end);
+    }
+  };
+
+  static void transmitGroup(size_t const aShard) noexcept {
+    GroupVisitor visitor(aShard);
+    if constexpr(csShardCount == 1u) {
+      tQueue::popGroup(visitor, csTransmitPauseLength);
+    }
+    else {
+      tQueue::popGroup(visitor, csTransmitPauseLength, aShard);
+    }
+  }
+
+  /// Sequence 0 arrives last, so after a gap the rest of the group up to and including
+  /// it is discarded, otherwise the first value would appear as a line of its own.
+  static void checkAndInsertAndTransmit(TaskId const aTaskId, tMessage const &aMessage, size_t const aShard) noexcept {
+    auto &group = *(*sPendingGroups)[aTaskId];
+    bool &discarding = (*sGroupDiscardings)[aTaskId];
     auto sequence = aMessage.getMessageSequence();
-    if(list->empty()) {
-      if(sequence <= csSequence1 && sAllocator->hasFree()) {
-        ready = push(*list, aMessage, sequence);
+    if(sequence == csSequence1) {  // A new group starts, even if the previous one was incomplete.
+      if(!group.empty()) {
+        countDiscarded(aTaskId, group.size(), 1u);
       }
       else { // nothing to do
       }
+      group.clear();
+      discarding = false;
+    }
+    else { // nothing to do
+    }
+    if(discarding) {
+      countDiscarded(aTaskId, 1u, 0u);
+      discarding = (sequence != csSequence0);
     }
     else {
-      auto lastSequence = list->back().getMessageSequence();
-      if((sequence == csSequence0 || sequence == lastSequence + 1u) && sAllocator->hasFree()) {
-        ready = push(*list, aMessage, sequence);
+      bool inOrder;
+      if(group.empty()) {
+        inOrder = sequence <= csSequence1;
       }
       else {
-        list->clear();
+        inOrder = sequence == csSequence0 || sequence == group.getLastSequence() + 1u;
+      }
+      if(inOrder && sequence == csSequence0) {
+        transmit(group, aMessage, aShard);
+      }
+      else if(!inOrder || !group.append(aMessage, *sAllocators[aShard], sBatchTimes[aShard])) {
+        countDiscarded(aTaskId, group.size() + 1u, 1u);
+        group.clear();
+        discarding = (sequence != csSequence0);
+      }
+      else { // nothing to do
       }
     }
-    if (ready) {
-      transmit(*list);
+  }
+
+  /// A task shutting down never completes its partial group, which would keep its pool nodes until the TaskId is reused.
+  static void discardPendingGroup(TaskId const aTaskId) noexcept {
+    auto &group = *(*sPendingGroups)[aTaskId];
+    if(!group.empty()) {
+      countDiscarded(aTaskId, group.size(), 1u);
+      group.clear();
     }
     else { // nothing to do
     }
+    (*sGroupDiscardings)[aTaskId] = false;
   }
 
-  static bool push(MessageQueue &aList, tMessage const &aMessage, MessageSequence const aSequence) noexcept {
-    bool result;
-    if(aSequence == csSequence0) {
-      aList.push_front(aMessage);
-      result = true;
+  /// Flushes the partial groups of the shard older than csPartialGroupTimeout, so a stalled
+  /// task can't hold pool nodes forever. The line is prefixed to tell the task, as its first
+  /// message carrying the header is still missing. Should the task resume the group, the rest
+  /// is discarded message by message, as the group was already counted.
+  static void evictStaleGroups(size_t const aShard) noexcept {
+    LogTime const now = sBatchTimes[aShard];
+    if(now - sLastEvictionChecks[aShard] >= csEvictionCheckPeriod) {
+      sLastEvictionChecks[aShard] = now;
+      for(size_t i = 0u; i < csMaxTotalTaskCount; ++i) {
+        auto &group = *(*sPendingGroups)[i];
+        if(getShard(static_cast<TaskId>(i)) == aShard && !group.empty() && now - group.getStarted() >= csPartialGroupTimeout) {
+          bool committed = false;
+          while(!committed) {
+            auto [begin, end] = getLineBuffer(aShard);
+            tConverter converter(begin, end);
+            converter.convert(csTruncatedGroup, 0u, 0u);
+            converter.convert(static_cast<TaskId>(i), sConfig->taskIdFormat.mBase, sConfig->taskIdFormat.mFill);
+            converter.convert(csLostGroupsEnd, 0u, 0u);
+            group.output(converter);
+            converter.terminateSequence();
+            committed = commitLine(begin, converter.end(), aShard);
+          }
+          group.clear();
+          countDiscarded(static_cast<TaskId>(i), 0u, 1u);
+          (*sGroupDiscardings)[i] = true;
+        }
+        else { // nothing to do
+        }
+      }
     }
-    else {
-      aList.push_back(aMessage);
-      result = false;
+    else { // nothing to do
     }
-    return result;
   }
 
-  static void transmit(MessageQueue &aList) noexcept {
-    auto [begin, end] = tSender::getBuffer();
-    tConverter converter(begin, end);
-    for(auto &message : aList) {
-      message.template output<tConverter>(converter);
+  static void countDiscarded(TaskId const aTaskId, size_t const aMessageCount, uint32_t const aGroupCount) noexcept {
+    auto &losses = sLosses[aTaskId];
+    losses.mDiscardedMessages.fetch_add(aMessageCount, std::memory_order_relaxed);
+    losses.mDiscardedGroups.fetch_add(aGroupCount, std::memory_order_relaxed);
+  }
+
+  /// Emits a "[N groups lost on task X]" line for each task of the shard which lost groups
+  /// since the previous one, at most once in csLossReportPeriod unless forced.
+  static void reportLosses(size_t const aShard, bool const aForce) noexcept {
+    LogTime const now = tAppInterface::getLogTime();
+    if(aForce || now - sLastLossReports[aShard] >= csLossReportPeriod) {
+      sLastLossReports[aShard] = now;
+      for(size_t i = 0u; i < csMaxTotalTaskCount; ++i) {
+        auto &losses = sLosses[i];
+        uint32_t const lost = losses.mRejectedGroups.load(std::memory_order_relaxed) + losses.mDiscardedGroups.load(std::memory_order_relaxed);
+        if(getShard(static_cast<TaskId>(i)) == aShard && lost != losses.mReportedGroups) {
+          bool committed = false;
+          while(!committed) {
+            auto [begin, end] = getLineBuffer(aShard);
+            tConverter converter(begin, end);
+            converter.convert(csLostGroupsBegin, 0u, 0u);
+            converter.convert(lost - losses.mReportedGroups, sConfig->defaultFormat.mBase, 0u);
+            converter.convert(csLostGroupsMiddle, 0u, 0u);
+            converter.convert(static_cast<TaskId>(i), sConfig->taskIdFormat.mBase, sConfig->taskIdFormat.mFill);
+            converter.convert(csLostGroupsEnd, 0u, 0u);
+            converter.terminateSequence();
+            committed = commitLine(begin, converter.end(), aShard);
+          }
+          losses.mReportedGroups = lost;
+        }
+        else { // nothing to do
+        }
+      }
+    }
+    else { // nothing to do
     }
-    aList.clear();
-    converter.terminateSequence();
-    tSender::send(begin, converter.end());
+  }
+
+  static void transmit(PendingGroup &aGroup, tMessage const &aFirst, size_t const aShard) noexcept {
+    bool committed = false;
+    while(!committed) {
+      auto [begin, end] = getLineBuffer(aShard);
+      tConverter converter(begin, end);
+      aFirst.template output<tConverter>(converter);
+      aGroup.output(converter);
+      converter.terminateSequence();
+      committed = commitLine(begin, converter.end(), aShard);
+    }
+    aGroup.clear();
   }
 
   static void doSendAtomicBuffer() noexcept {
+    flushCoalesced(0u);
     auto [inBuffer, inIndex] = tAtomicBuffer::getBuffer();
-    auto [outBegin, outEnd] = tSender::getBuffer();
     size_t processed = 0u;
     while(processed < csAtomicBufferSize) {
+      auto [outBegin, outEnd] = getSenderBuffer(0u);   // Double buffering senders may hand out another one after each send.
       tConverter converter(outBegin, outEnd);
       auto validOutEnd = converter.end();
-      while((converter.end() != outEnd) && (processed < csAtomicBufferSize)) {
+      bool full = false;
+      while(!full && (processed < csAtomicBufferSize)) {
         if(inBuffer[inIndex] != csAtomicBufferInvalidValue) {
           converter.convert(inBuffer[inIndex], sConfig->atomicFormat.mBase, sConfig->atomicFormat.mFill);
-          if (converter.end() != outEnd) {
+          // Text converters truncate at the end, binary ones leave out what does not fit.
+          full = (converter.end() == outEnd) || (converter.end() == validOutEnd);
+          if(!full) {
             validOutEnd = converter.end();
           } else { // nothing to do
           }
         }
         else { // nothing to do
         }
-        inIndex = (inIndex + 1u) % csAtomicBufferSize;
-        ++processed;
+        if(!full || validOutEnd == outBegin) {   // Otherwise the value goes again into the next buffer, unless it fits in none.
+          inIndex = (inIndex + 1u) % csAtomicBufferSize;
+          ++processed;
+        }
+        else { // nothing to do
+        }
       }
-      tSender::send(outBegin, validOutEnd);
+      if constexpr(tConverter::csWholeLines) {   // Each part becomes a line of its own, these converters write whole values only.
+        if(validOutEnd != outBegin) {
+          converter.terminateSequence();
+          validOutEnd = converter.end();
+        }
+        else { // nothing to do
+        }
+      }
+      else { // nothing to do
+      }
+      sendFromShard(outBegin, validOutEnd, 0u);
+    }
+    if constexpr(!tConverter::csWholeLines) {
+      auto [outBegin, outEnd] = getSenderBuffer(0u);
+      tConverter converter(outBegin, outEnd);
+      converter.terminateSequence();
+      sendFromShard(outBegin, converter.end(), 0u);
+    }
+    else { // nothing to do
     }
-    tConverter converter(outBegin, outEnd);
-    converter.terminateSequence();
-    tSender::send(outBegin, converter.end());
   }
 };
 
@@ -7,6 +7,7 @@
 #include <chrono>
 #include <thread>
 #include <unordered_set>
+#include <vector>
 #include <condition_variable>
 
 namespace nowtech::log {
@@ -39,26 +40,26 @@ public:
   };
 
 private:
+  /// Counting, because the transmitters of QueueSharded may finish at the same time.
   class Semaphore final {
   private:
-    std::atomic<bool>            mNotified = false;
+    size_t                       mCount = 0u;
     std::mutex                   mMutex;
-    std::unique_lock<std::mutex> mLock;
     std::condition_variable      mConditionVariable;
 
   public:
-    Semaphore() noexcept : mLock(mMutex) {
-    }
+    Semaphore() noexcept = default;
 
     void wait() noexcept {
-      mNotified = false;
-      mConditionVariable.wait(mLock, [this] { return mNotified == true; });
+      std::unique_lock<std::mutex> lock(mMutex);
+      mConditionVariable.wait(lock, [this] { return mCount > 0u; });
+      --mCount;
     }
 
     void notify() noexcept {
       {
         std::lock_guard<std::mutex> lock(mMutex);
-        mNotified = true;
+        ++mCount;
       }
       mConditionVariable.notify_one();
     }
@@ -80,7 +81,7 @@ private:
   inline static thread_local std::string shTaskName;
   inline static std::unordered_set<TaskId> sFreeTaskIds;
   inline static std::mutex sRegistrationMutex;
-  inline static std::thread *sTransmitterThread;
+  inline static std::vector<std::thread> sTransmitterThreads;
   
   AppInterfaceStd() = delete;
 
@@ -92,17 +93,22 @@ public:
   }
 
   static void init(void(*aFunction)(void)) {
+    init(&aFunction, 1u);
+  }
+
+  /// Starts a transmitter thread for each function, used with QueueSharded.
+  static void init(void(* const * const aFunctions)(void), size_t const aCount) {
     init();
-    sTransmitterThread = new std::thread(aFunction);
+    for(size_t i = 0u; i < aCount; ++i) {
+      sTransmitterThreads.emplace_back(aFunctions[i]);
+    }
   }
 
   static void done() {
-    if(sTransmitterThread != nullptr) {
-      sTransmitterThread->join();
-      delete sTransmitterThread;
-    }
-    else { // nothing to do
+    for(auto &thread : sTransmitterThreads) {
+      thread.join();
     }
+    sTransmitterThreads.clear();
     sFreeTaskIds.clear();
   }
 
@@ -0,0 +1,342 @@
+#ifndef NOWTECH_LOG_CONVERTER_BINARY
+#define NOWTECH_LOG_CONVERTER_BINARY
+
+#include "LogMessageBase.h"
+#include <cstring>
+#include <type_traits>
+
+namespace nowtech::log {
+
+/// Type of a record in the output of ConverterBinary, stored in the low 5 bits of its first byte.
+enum class BinaryTag : uint8_t {
+  cEndOfLine      =  0u, // nothing follows
+  cUnsigned       =  1u, // LEB128 varint
+  cSigned         =  2u, // zigzag encoded LEB128 varint
+  cFloat          =  3u, // IEEE 754 bits, 4 bytes little endian
+  cDouble         =  4u, // IEEE 754 bits, 8 bytes little endian, long double is narrowed to this
+  cChar           =  5u, // 1 byte
+  cString         =  6u, // varint length and the characters, followed by a space in text
+  cStringChunk    =  7u, // the same without the space, a transient string continues
+  cFalse          =  8u, // nothing follows
+  cTrue           =  9u, // nothing follows
+  cTimestamp      = 10u, // varint of the header time
+  cTimestampDelta = 11u, // zigzag varint difference to the previous header time
+  cStringDefine   = 12u, // varint id, varint length and the characters, used like cString
+  cStringId       = 13u  // varint id of a string defined before, followed by a space in text
+};
+
+/// Independent of STL
+/// Emits a compact tagged record for each item instead of text, so the transmitter
+/// spends no time on formatting. *tools/log-decode-binary.cpp* renders the records
+/// into the usual text layout later using ConverterCustomText.
+/// The base and the fill follow the tag byte only for numbers not in plain decimal,
+/// marked by csFormatFollows in the tag. A record is written whole or not at all,
+/// and the last byte of the buffer is kept for the end of line.
+/// The header time, marked with LogFormat::asTimestamp(), is sent as the difference
+/// to the previous one, with an absolute value every tTimestampKeyPeriod, so a decoder
+/// may also join a running stream. The previous time is a static variable, so the
+/// several transmitters of QueueSharded need tTimestampKeyPeriod == 1 to send only
+/// absolute values.
+/// With tStringIdCapacity > 0, strings logged by pointer are taken for constants,
+/// and only their first occurrence carries the characters in a definition record.
+/// Later ones send only the id, which is the slot of the pointer in a static hash
+/// table of tStringIdCapacity pointers. Once it is 3/4 full, new strings go inline.
+/// The table is not synchronized either, so it needs a single transmitter.
+template<typename tMessage, uint32_t tTimestampKeyPeriod = 64u, size_t tStringIdCapacity = 0u>
+class ConverterBinary final {
+public:
+  using tMessage_          = tMessage;
+  using ConversionResult   = char;
+  using Iterator           = char*;
+  static constexpr Iterator csNullIterator = nullptr; // Used in SenderVoid to return void begin-end pair.
+  static constexpr bool     csSupportFloatingPoint = tMessage::csSupportFloatingPoint;
+  static constexpr bool     csWholeLines = false;  // Lines may be sent in parts.
+
+  static constexpr uint8_t  csTagMask              = 0x1fu;
+  static constexpr uint8_t  csFormatFollows        = 0x20u;
+  static constexpr uint8_t  csDefaultBase          = 10u;
+
+private:
+  static constexpr size_t   csMaxVarintSize        = 10u;
+  static constexpr size_t   csMaxRecordSize        = 3u + csMaxVarintSize;
+  static constexpr uint8_t  csVarintMask           = 0x7fu;
+  static constexpr uint8_t  csVarintContinues      = 0x80u;
+
+  static constexpr size_t   csStringKeyCount       = tStringIdCapacity > 0u ? tStringIdCapacity : 1u;
+  static constexpr size_t   csMaxStringIdCount     = tStringIdCapacity - tStringIdCapacity / 4u;
+
+  static_assert(tTimestampKeyPeriod > 0u);
+
+  inline static uint64_t     sLastTimestamp  = 0u;
+  inline static uint32_t     sTimestampCount = 0u;
+  inline static char const  *sStringKeys[csStringKeyCount];
+  inline static size_t       sStringIdCount  = 0u;
+
+  Iterator       mBegin;
+  Iterator const mEnd;
+
+public:
+  ConverterBinary(Iterator aBegin, Iterator const aEnd) noexcept
+  : mBegin(aBegin)
+  , mEnd(aEnd) {
+  }
+
+  ConverterBinary(ConverterBinary const &) = delete;
+  ConverterBinary(ConverterBinary &&) = delete;
+  ConverterBinary& operator=(ConverterBinary const &) = delete;
+  ConverterBinary& operator=(ConverterBinary &&) = delete;
+
+  Iterator end() const noexcept {
+    return mBegin;
+  }
+
+  void convert(ShutdownMessageContent const, uint8_t const, uint8_t const) noexcept { // nothing to do
+  }
+
+  template <typename tDummy = void>
+  auto convert(float const aValue, uint8_t const aBase, uint8_t const aFill) noexcept -> std::enable_if_t<csSupportFloatingPoint, tDummy> {
+    uint32_t bits;
+    std::memcpy(&bits, &aValue, sizeof(bits));
+    appendFloatingPoint(BinaryTag::cFloat, bits, sizeof(bits), aBase, aFill);
+  }
+
+  template <typename tDummy = void>
+  auto convert(double const aValue, uint8_t const aBase, uint8_t const aFill) noexcept -> std::enable_if_t<csSupportFloatingPoint, tDummy> {
+    uint64_t bits;
+    std::memcpy(&bits, &aValue, sizeof(bits));
+    appendFloatingPoint(BinaryTag::cDouble, bits, sizeof(bits), aBase, aFill);
+  }
+
+  template <typename tDummy = void>
+  auto convert(long double const aValue, uint8_t const aBase, uint8_t const aFill) noexcept -> std::enable_if_t<csSupportFloatingPoint, tDummy> {
+    convert(static_cast<double>(aValue), aBase, aFill);
+  }
+
+  void convert(uint8_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendUnsigned(aValue, aBase, aFill);
+  }
+
+  void convert(uint16_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendUnsigned(aValue, aBase, aFill);
+  }
+
+  void convert(uint32_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendUnsigned(aValue, aBase, aFill);
+  }
+
+  void convert(uint64_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendUnsigned(aValue, aBase, aFill);
+  }
+
+  void convert(int8_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendSigned(aValue, aBase, aFill);
+  }
+
+  void convert(int16_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendSigned(aValue, aBase, aFill);
+  }
+
+  void convert(int32_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendSigned(aValue, aBase, aFill);
+  }
+
+  void convert(int64_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendSigned(aValue, aBase, aFill);
+  }
+
+  void convert(char const aValue, uint8_t const, uint8_t const) noexcept {
+    uint8_t record[2u] = { static_cast<uint8_t>(BinaryTag::cChar), static_cast<uint8_t>(aValue) };
+    commit(record, sizeof(record));
+  }
+
+  void convert(char const * const aValue, uint8_t const, uint8_t const aFill) noexcept {
+    if(tStringIdCapacity > 0u && !LogFormat::isStringContinued(aFill)) {   // Transient ones come with the mark in direct mode.
+      appendStringId(aValue);
+    }
+    else {
+      appendString(BinaryTag::cString, aValue, ~size_t{0u});
+    }
+  }
+
+  void convert(bool const aValue, uint8_t const, uint8_t const) noexcept {
+    uint8_t const record = static_cast<uint8_t>(aValue ? BinaryTag::cTrue : BinaryTag::cFalse);
+    commit(&record, 1u);
+  }
+
+  void convert(char const * const aValue, uint8_t const aFill) noexcept {   // extra function for MessageCompact
+    appendString(LogFormat::isStringContinued(aFill) ? BinaryTag::cStringChunk : BinaryTag::cString, aValue, ~size_t{0u});
+  }
+
+  void convert(std::array<char, tMessage::csPayloadSize> const &aValue, uint8_t const, uint8_t const aFill) noexcept {
+    appendString(LogFormat::isStringContinued(aFill) ? BinaryTag::cStringChunk : BinaryTag::cString, aValue.data(), aValue.size());
+  }
+
+  void terminateSequence() noexcept {
+    if(mBegin < mEnd) {
+      *mBegin = static_cast<char>(BinaryTag::cEndOfLine);
+      ++mBegin;
+    }
+    else { // nothing to do
+    }
+  }
+
+private:
+  /// Keeps the last byte for terminateSequence.
+  bool fits(size_t const aSize) const noexcept {
+    return static_cast<size_t>(mEnd - mBegin) > aSize;
+  }
+
+  void commit(uint8_t const * const aRecord, size_t const aSize) noexcept {
+    if(fits(aSize)) {
+      std::memcpy(mBegin, aRecord, aSize);
+      mBegin += aSize;
+    }
+    else { // nothing to do
+    }
+  }
+
+  static size_t writeVarint(uint8_t * const aDestination, uint64_t const aValue) noexcept {
+    uint64_t value = aValue;
+    size_t size = 0u;
+    while(value > csVarintMask) {
+      aDestination[size] = static_cast<uint8_t>(value & csVarintMask) | csVarintContinues;
+      value >>= 7u;
+      ++size;
+    }
+    aDestination[size] = static_cast<uint8_t>(value);
+    return size + 1u;
+  }
+
+  static constexpr uint64_t zigzag(int64_t const aValue) noexcept {
+    return (static_cast<uint64_t>(aValue) << 1u) ^ static_cast<uint64_t>(aValue >> 63u);
+  }
+
+  /// @return the size of the tag and the optional format.
+  static size_t writeTag(uint8_t * const aDestination, BinaryTag const aTag, uint8_t const aBase, uint8_t const aFill) noexcept {
+    size_t result;
+    if(aBase == csDefaultBase && aFill == 0u) {
+      aDestination[0] = static_cast<uint8_t>(aTag);
+      result = 1u;
+    }
+    else {
+      aDestination[0] = static_cast<uint8_t>(aTag) | csFormatFollows;
+      aDestination[1] = aBase;
+      aDestination[2] = aFill;
+      result = 3u;
+    }
+    return result;
+  }
+
+  void appendUnsigned(uint64_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    uint8_t record[csMaxRecordSize];
+    size_t size;
+    if(LogFormat::isTimestamp(aFill)) {
+      bool key = true;
+      if constexpr(tTimestampKeyPeriod > 1u) {
+        key = sTimestampCount % tTimestampKeyPeriod == 0u;
+      }
+      else { // nothing to do
+      }
+      size = writeTag(record, key ? BinaryTag::cTimestamp : BinaryTag::cTimestampDelta, aBase, LogFormat::getIntegerFill(aFill));
+      size += writeVarint(record + size, key ? aValue : zigzag(static_cast<int64_t>(aValue - sLastTimestamp)));
+      if constexpr(tTimestampKeyPeriod > 1u) {
+        if(fits(size)) {
+          sLastTimestamp = aValue;
+          ++sTimestampCount;
+        }
+        else { // nothing to do
+        }
+      }
+      else { // nothing to do
+      }
+    }
+    else {
+      size = writeTag(record, BinaryTag::cUnsigned, aBase, LogFormat::getIntegerFill(aFill));
+      size += writeVarint(record + size, aValue);
+    }
+    commit(record, size);
+  }
+
+  void appendSigned(int64_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    uint8_t record[csMaxRecordSize];
+    size_t size = writeTag(record, BinaryTag::cSigned, aBase, LogFormat::getIntegerFill(aFill));
+    size += writeVarint(record + size, zigzag(aValue));
+    commit(record, size);
+  }
+
+  void appendFloatingPoint(BinaryTag const aTag, uint64_t const aBits, size_t const aByteCount, uint8_t const aBase, uint8_t const aFill) noexcept {
+    uint8_t record[csMaxRecordSize];
+    size_t size = writeTag(record, aTag, aBase, aFill);
+    for(size_t i = 0u; i < aByteCount; ++i) {
+      record[size] = static_cast<uint8_t>(aBits >> (8u * i));
+      ++size;
+    }
+    commit(record, size);
+  }
+
+  static size_t findSlot(char const * const aValue) noexcept {
+    size_t slot = static_cast<size_t>(reinterpret_cast<uintptr_t>(aValue) % csStringKeyCount);
+    while(sStringKeys[slot] != nullptr && sStringKeys[slot] != aValue) {
+      slot = (slot + 1u) % csStringKeyCount;
+    }
+    return slot;
+  }
+
+  /// The table only gets the pointer if its definition record fits, so the decoder knows each id it receives.
+  void appendStringId(char const * const aValue) noexcept {
+    size_t const slot = findSlot(aValue);
+    uint8_t header[1u + 2u * csMaxVarintSize];
+    if(sStringKeys[slot] == aValue) {
+      header[0] = static_cast<uint8_t>(BinaryTag::cStringId);
+      commit(header, 1u + writeVarint(header + 1u, slot));
+    }
+    else if(sStringIdCount < csMaxStringIdCount) {
+      size_t const length = std::strlen(aValue);
+      header[0] = static_cast<uint8_t>(BinaryTag::cStringDefine);
+      size_t headerSize = 1u + writeVarint(header + 1u, slot);
+      headerSize += writeVarint(header + headerSize, length);
+      if(fits(headerSize + length)) {
+        std::memcpy(mBegin, header, headerSize);
+        std::memcpy(mBegin + headerSize, aValue, length);
+        mBegin += headerSize + length;
+        sStringKeys[slot] = aValue;
+        ++sStringIdCount;
+      }
+      else {
+        appendString(BinaryTag::cString, aValue, length);
+      }
+    }
+    else {
+      appendString(BinaryTag::cString, aValue, ~size_t{0u});
+    }
+  }
+
+  /// The characters are truncated to the space left, like in ConverterCustomText.
+  void appendString(BinaryTag const aTag, char const * const aValue, size_t const aMaxLength) noexcept {
+    size_t length = 0u;
+    while(length < aMaxLength && aValue[length] != 0) {
+      ++length;
+    }
+    uint8_t header[csMaxRecordSize];
+    header[0] = static_cast<uint8_t>(aTag);
+    size_t const available = static_cast<size_t>(mEnd - mBegin);
+    size_t headerSize = 1u + writeVarint(header + 1u, length);
+    if(headerSize + length >= available && available > headerSize + 1u) {
+      length = available - headerSize - 1u;
+      headerSize = 1u + writeVarint(header + 1u, length);   // Can only get shorter.
+    }
+    else { // nothing to do
+    }
+    if(fits(headerSize + length)) {
+      std::memcpy(mBegin, header, headerSize);
+      std::memcpy(mBegin + headerSize, aValue, length);
+      mBegin += headerSize + length;
+    }
+    else { // nothing to do
+    }
+  }
+};
+
+}
+
+#endif
@@ -2,12 +2,19 @@
 #define NOWTECH_LOG_CONVERTER_CUSTOM_CHARACTER
 
 #include "LogNumericSystem.h"
+#include "LogShortestFloat.h"
+#include "LogIntegerFloat.h"
 #include <cmath>
+#include <cstring>
+#include <type_traits>
 
 namespace nowtech::log {
 
 /// Independent of STL
-template<typename tMessage, bool tArchitecture64, uint8_t tAppendStackBufferSize, bool tAppendBasePrefix, bool tAlignSigned>
+/// tShortestFloat enables LogFormatConfig::Fs for float and double, otherwise it falls back to the maximum digits.
+/// tIntegerFloat formats on the bit pattern using only integer arithmetic, so it needs neither an FPU nor libm.
+/// It applies to float only with at most 9 digits, double and long double keep the floating point path.
+template<typename tMessage, bool tArchitecture64, uint8_t tAppendStackBufferSize, bool tAppendBasePrefix, bool tAlignSigned, bool tShortestFloat = false, bool tIntegerFloat = false>
 class ConverterCustomText final {
 public:
   using tMessage_          = tMessage;
@@ -15,6 +22,7 @@ public:
   using Iterator           = char*;
   static constexpr Iterator csNullIterator = nullptr; // Used in SenderVoid to return void begin-end pair.
   static constexpr bool     csSupportFloatingPoint = tMessage::csSupportFloatingPoint;
+  static constexpr bool     csWholeLines = false;  // Lines may be sent in parts.
 
 private:
   using IntegerConversionUnsigned = std::conditional_t<tArchitecture64, uint64_t, uint32_t>;
@@ -23,6 +31,8 @@ private:
   static constexpr uint8_t csMaxDigitCountFloat      =  8u;
   static constexpr uint8_t csMaxDigitCountDouble     = 16u;
   static constexpr uint8_t csMaxDigitCountLongDouble = 34u;
+  static constexpr uint8_t csMaxDigitCountShortest   = 17u;
+  static constexpr uint8_t csMaxDigitCountFixed      = 18u;   // Digits of fixed notation, which still fit in uint64_t.
 
   static constexpr char csNumericError            = '#';
   static constexpr char csEndOfLine               = '\n';
@@ -36,6 +46,9 @@ private:
   static constexpr char csPlus                    = '+';
   static constexpr char csScientificE             = 'e';
 
+  static constexpr uint32_t csFloatSignBit        = 0x80000000u;
+  static constexpr uint32_t csFloatInfinity       = 0x7f800000u;
+
   inline static constexpr char csNan[]            = "nan";
   inline static constexpr char csInf[]            = "inf";
   inline static constexpr char csTrue[]           = "true";
@@ -64,19 +77,29 @@ public:
 
   template <typename tDummy = void>
   auto convert(float const aValue, uint8_t const, uint8_t const aFill) noexcept -> std::enable_if_t<csSupportFloatingPoint, tDummy> {
-    append(static_cast<long double>(aValue), aFill == 0u ? csMaxDigitCountFloat : aFill);
+    if(tShortestFloat && aFill == LogFormat::csFillValueShortest) {
+      appendShortest(aValue);
+    }
+    else {
+      appendFloat(aValue, aFill, csMaxDigitCountFloat);
+    }
     appendSpace();
   }
 
   template <typename tDummy = void>
   auto convert(double const aValue, uint8_t const, uint8_t const aFill) noexcept -> std::enable_if_t<csSupportFloatingPoint, tDummy> {
-    append(static_cast<long double>(aValue), aFill == 0u ? csMaxDigitCountDouble : aFill);
+    if(tShortestFloat && aFill == LogFormat::csFillValueShortest) {
+      appendShortest(aValue);
+    }
+    else {
+      appendFloat(aValue, aFill, csMaxDigitCountDouble);
+    }
     appendSpace();
   }
 
   template <typename tDummy = void>
   auto convert(long double const aValue, uint8_t const, uint8_t const aFill) noexcept -> std::enable_if_t<csSupportFloatingPoint, tDummy> {
-    append(aValue, aFill == 0u ? csMaxDigitCountLongDouble : aFill);
+    appendFloat(aValue, aFill, csMaxDigitCountLongDouble);
     appendSpace();
   }
 
@@ -137,7 +160,7 @@ public:
 
   void convert(char const * const aValue, uint8_t const aFill) noexcept {   // extra function for MessageCompact
     append(aValue);
-    if(aFill < LogFormat::csFillValueStoreString) {   // Antipattern to use the fill for other purposes, but we go for space saving.
+    if(!LogFormat::isStringContinued(aFill)) {   // Antipattern to use the fill for other purposes, but we go for space saving.
       appendSpace();
     }
     else { // nothing to do
@@ -179,10 +202,130 @@ private:
     '0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'
   };
 
+  /// Two digits of each value below tBase * tBase, so a division yields two characters.
+  template<uint32_t tBase>
+  struct DigitPairs final {
+    char mDigits[2u * tBase * tBase];
+
+    constexpr DigitPairs() noexcept : mDigits{} {
+      for(uint32_t i = 0u; i < tBase * tBase; ++i) {
+        mDigits[2u * i]      = csDigit2char[i / tBase];
+        mDigits[2u * i + 1u] = csDigit2char[i % tBase];
+      }
+    }
+  };
+
+  inline static constexpr DigitPairs<10u> csDecimalPairs{};
+  inline static constexpr DigitPairs<16u> csHexadecimalPairs{};
+
+  inline static constexpr uint64_t csPowersOf10[] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+    10000000000u, 100000000000u, 1000000000000u, 10000000000000u, 100000000000000u,
+    1000000000000000u, 10000000000000000u, 100000000000000000u, 1000000000000000000u, 10000000000000000000u
+  };
+
+  /// @return the shift of a power of two base, 0 otherwise.
+  static constexpr uint8_t getBaseShift(uint32_t const aBase) noexcept {
+    return aBase == 2u ? 1u : aBase == 4u ? 2u : aBase == 8u ? 3u : aBase == 16u ? 4u : 0u;
+  }
+
+  /// @return the number of bits needed to represent aValue, 0 for 0, like std::bit_width of C++20.
+  template<typename tMagnitude>
+  static constexpr uint8_t getBitWidth(tMagnitude const aValue) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return aValue == 0u ? 0u : static_cast<uint8_t>(sizeof(unsigned long long) * 8u - static_cast<uint32_t>(__builtin_clzll(static_cast<unsigned long long>(aValue))));
+#else
+    uint8_t result = 0u;
+    for(tMagnitude value = aValue; value != 0u; value >>= 1u) {
+      ++result;
+    }
+    return result;
+#endif
+  }
+
+  /// Only for base 10 and the powers of two, where it costs no division.
+  template<typename tMagnitude>
+  static uint8_t countDigits(tMagnitude const aValue, tMagnitude const aBase) noexcept {
+    uint8_t result;
+    if(aBase == 10u) {
+      uint8_t const estimate = static_cast<uint8_t>((static_cast<uint32_t>(getBitWidth(aValue)) * 1233u) >> 12u); // 1233 / 4096 ~ log10(2)
+      result = estimate + (aValue >= csPowersOf10[estimate] ? 1u : 0u);
+    }
+    else {
+      uint8_t const shift = getBaseShift(static_cast<uint32_t>(aBase));
+      result = static_cast<uint8_t>((getBitWidth(aValue) + shift - 1u) / shift);
+    }
+    return result == 0u ? 1u : result;
+  }
+
+  /// Writes exactly aDigitCount digits of base 10 or a power of two ending at aDestination + aDigitCount.
+  template<typename tMagnitude>
+  static void writeDigits(char * const aDestination, tMagnitude const aValue, tMagnitude const aBase, uint8_t const aDigitCount) noexcept {
+    char *where = aDestination + aDigitCount;
+    tMagnitude value = aValue;
+    uint8_t const shift = getBaseShift(static_cast<uint32_t>(aBase));
+    if(aBase == 10u) {
+      while(value >= 100u) {
+        char const * const pair = csDecimalPairs.mDigits + 2u * static_cast<uint32_t>(value % 100u);
+        value /= 100u;
+        where -= 2;
+        where[0] = pair[0];
+        where[1] = pair[1];
+      }
+      if(value >= 10u) {
+        char const * const pair = csDecimalPairs.mDigits + 2u * static_cast<uint32_t>(value);
+        where[-2] = pair[0];
+        where[-1] = pair[1];
+      }
+      else {
+        where[-1] = csDigit2char[value];
+      }
+    }
+    else if(aBase == 16u) {
+      uint8_t remaining = aDigitCount;
+      while(remaining >= 2u) {
+        char const * const pair = csHexadecimalPairs.mDigits + 2u * static_cast<uint32_t>(value & 0xffu);
+        value >>= 8u;
+        where -= 2;
+        where[0] = pair[0];
+        where[1] = pair[1];
+        remaining -= 2u;
+      }
+      if(remaining > 0u) {
+        where[-1] = csDigit2char[value & 0xfu];
+      }
+      else { // nothing to do
+      }
+    }
+    else {
+      tMagnitude const mask = aBase - 1u;
+      for(uint8_t i = 0u; i < aDigitCount; ++i) {
+        --where;
+        *where = csDigit2char[value & mask];
+        value >>= shift;
+      }
+    }
+  }
+
+  /// Exotic bases keep the runtime division, filling the buffer backwards in one pass as the count is unknown.
+  /// @return the first digit, which is aBufferEnd - tAppendStackBufferSize if the buffer was too short.
+  template<typename tMagnitude>
+  static char const * writeDigitsBackwards(char * const aBufferEnd, tMagnitude const aValue, tMagnitude const aBase) noexcept {
+    char *where = aBufferEnd;
+    tMagnitude value = aValue;
+    do {
+      --where;
+      *where = csDigit2char[value % aBase];
+      value /= aBase;
+    } while((value != 0u) && (where > aBufferEnd - tAppendStackBufferSize));
+    return where;
+  }
+
+  /// For base 10 and the powers of two it counts the digits first, so they can go right to their
+  /// final place. Only a number not fitting in the remaining buffer takes a detour through the stack.
   template<typename tValue>
   void append(tValue const aValue, tValue const aBase, uint8_t const aFill) noexcept {
-    tValue tmpValue = aValue;
-    uint8_t tmpFill = aFill;
+    using Magnitude = std::make_unsigned_t<tValue>;
     if((aBase <= NumericSystem::csInvalid) || (aBase > NumericSystem::csBaseMax)) {
       append(csNumericError);
       return;
@@ -205,45 +348,227 @@ private:
       else { // nothing to do
       }
     }
+    bool const negative = aValue < 0;
+    Magnitude const magnitude = negative ? static_cast<Magnitude>(Magnitude{0u} - static_cast<Magnitude>(aValue)) : static_cast<Magnitude>(aValue);
+    Magnitude const base = static_cast<Magnitude>(aBase);
     char tmpBuffer[tAppendStackBufferSize];
-    uint8_t where = 0u;
-    bool negative = aValue < 0;
-    do {
-      tValue mod = tmpValue % aBase;
-      if(mod < 0) {
-        mod = -mod;
-      }
-      else { // nothing to do
-      }
-      tmpBuffer[where] = csDigit2char[mod];
-      ++where;
-      tmpValue /= aBase;
-    } while((tmpValue != 0) && (where < tAppendStackBufferSize));
-    if(where >= tAppendStackBufferSize) {
+    char const *digits = nullptr;   // Already converted to the stack.
+    uint8_t digitCount;
+    if(aBase == 10u || getBaseShift(static_cast<uint32_t>(aBase)) > 0u) {
+      digitCount = countDigits(magnitude, base);
+    }
+    else {
+      digits = writeDigitsBackwards(tmpBuffer + tAppendStackBufferSize, magnitude, base);
+      digitCount = static_cast<uint8_t>(tmpBuffer + tAppendStackBufferSize - digits);
+    }
+    if(digitCount >= tAppendStackBufferSize) {
       append(csNumericError);
       return;
     }
     else { // nothing to do
     }
+    uint8_t const integerFill = LogFormat::getIntegerFill(aFill);
     if(negative) {
       append(csMinus);
     }
-    else if(tAlignSigned && (aFill > 0u)) {
+    else if(tAlignSigned && (integerFill > 0u)) {
       append(csSpace);
     }
     else { // nothing to do
     }
-    if(tmpFill > where) {
-      tmpFill -= where;
-      while(tmpFill > 0u) {
-        append(csNumericFill);
-        --tmpFill;
+    for(uint8_t fill = integerFill; fill > digitCount; --fill) {
+      append(csNumericFill);
+    }
+    if(digits == nullptr && mEnd - mBegin >= digitCount) {
+      writeDigits(mBegin, magnitude, base, digitCount);
+      mBegin += digitCount;
+    }
+    else {
+      if(digits == nullptr) {
+        writeDigits(tmpBuffer, magnitude, base, digitCount);
+        digits = tmpBuffer;
+      }
+      else { // nothing to do
+      }
+      for(uint8_t i = 0u; i < digitCount; ++i) {
+        append(digits[i]);
       }
     }
-    for(--where; where > 0u; --where) {
-      append(tmpBuffer[where]);
+  }
+
+  static constexpr uint8_t getDigitsNeeded(uint8_t const aFill, uint8_t const aMaxDigitCount) noexcept {
+    return (aFill == 0u || aFill >= LogFormat::csFillValueFixed) ? aMaxDigitCount : aFill;
+  }
+
+  /// Fixed notation for the LC::F* formats, the fixed-digit scientific mode otherwise.
+  /// Narrowing double to float would print wrong values, so only float goes to the integer path.
+  template<typename tValue>
+  void appendFloat(tValue const aValue, uint8_t const aFill, uint8_t const aMaxDigitCount) noexcept {
+    uint8_t const digitsNeeded = getDigitsNeeded(aFill, aMaxDigitCount);
+    if constexpr(tIntegerFloat && std::is_same_v<tValue, float>) {
+      if(LogFormat::isFixed(aFill)) {
+        appendFixedInteger(aValue, aFill - LogFormat::csFillValueFixed, digitsNeeded);
+      }
+      else {
+        appendInteger(aValue, digitsNeeded);
+      }
+    }
+    else {
+      if(LogFormat::isFixed(aFill)) {
+        appendFixed(static_cast<long double>(aValue), aFill - LogFormat::csFillValueFixed, digitsNeeded);
+      }
+      else {
+        append(static_cast<long double>(aValue), digitsNeeded);
+      }
+    }
+  }
+
+  /// Scales the value to an integer of 10^-aDecimals units, so the digits come from the integer kernels.
+  /// Only the fraction is multiplied, so the integral part stays exact. Values with more than
+  /// csMaxDigitCountFixed digits, infinity and nan go to the scientific mode.
+  void appendFixed(long double const aValue, uint8_t const aDecimals, uint8_t const aDigitsNeeded) noexcept {
+    long double const magnitude = aValue < 0.0l ? -aValue : aValue;
+    if(magnitude < static_cast<long double>(csPowersOf10[csMaxDigitCountFixed - aDecimals])) {
+      if(aValue < 0.0l) {
+        append(csMinus);
+      }
+      else if(tAlignSigned) {
+        append(csSpace);
+      }
+      else { // nothing to do
+      }
+      uint64_t const power = csPowersOf10[aDecimals];
+      uint64_t const integral = static_cast<uint64_t>(magnitude);
+      long double const fraction = (magnitude - static_cast<long double>(integral)) * static_cast<long double>(power);
+      uint64_t const scaledFraction = static_cast<uint64_t>(fraction);
+      appendScaled(integral * power + scaledFraction + (fraction - static_cast<long double>(scaledFraction) >= 0.5l ? 1u : 0u), aDecimals);
+    }
+    else {
+      append(aValue, aDigitsNeeded);
+    }
+  }
+
+  /// Same as appendFixed, but with integer arithmetic only and at most 9 digits.
+  void appendFixedInteger(float const aValue, uint8_t const aDecimals, uint8_t const aDigitsNeeded) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &aValue, sizeof(bits));
+    uint32_t const magnitude = bits & ~csFloatSignBit;
+    uint32_t scaled = 0u;
+    if(magnitude < csFloatInfinity && (magnitude == 0u || IntegerFloat::convertFixed(aValue, aDecimals, scaled))) {
+      if(magnitude != 0u && (bits & csFloatSignBit) != 0u) {
+        append(csMinus);
+      }
+      else if(tAlignSigned) {
+        append(csSpace);
+      }
+      else { // nothing to do
+      }
+      appendScaled(scaled, aDecimals);
+    }
+    else {
+      appendInteger(aValue, aDigitsNeeded);
+    }
+  }
+
+  /// Prints aScaled / 10^aDecimals with exactly aDecimals digits after the dot.
+  template<typename tMagnitude>
+  void appendScaled(tMagnitude const aScaled, uint8_t const aDecimals) noexcept {
+    tMagnitude const power = static_cast<tMagnitude>(csPowersOf10[aDecimals]);
+    append(aScaled / power, tMagnitude{10u}, 0u);
+    if(aDecimals > 0u) {
+      char digits[LogFormat::csMaxFixedDecimals];
+      std::memset(digits, csNumericFill, aDecimals);
+      writeDigits(digits, aScaled % power, tMagnitude{10u}, aDecimals);
+      append(csFractionDot);
+      for(uint8_t i = 0u; i < aDecimals; ++i) {
+        append(digits[i]);
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Same layout as the fixed-digit scientific mode, but only with the digits needed to read back the same value.
+  template<typename tValue>
+  void appendShortest(tValue const aValue) noexcept {
+    if(std::isnan(aValue)) {
+      append(csNan);
+    }
+    else if(std::isinf(aValue)) {
+      append(csInf);
+    }
+    else if(aValue == 0.0f) {
+      append(csNumericFill);
+    }
+    else {
+      if(aValue < 0.0f) {
+        append(csMinus);
+      }
+      else if(tAlignSigned) {
+        append(csSpace);
+      }
+      else { // nothing to do
+      }
+      auto [significand, exponent] = ShortestFloat::convert(aValue < 0.0f ? -aValue : aValue);
+      while(significand % 10u == 0u) {
+        significand /= 10u;
+        ++exponent;
+      }
+      appendScientific(significand, countDigits(significand, uint64_t{10u}), exponent);
+    }
+  }
+
+  /// Same layout as the fixed-digit scientific mode, with exactly aDigitsNeeded digits rounded half up.
+  void appendInteger(float const aValue, uint8_t const aDigitsNeeded) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &aValue, sizeof(bits));
+    uint32_t const magnitude = bits & ~csFloatSignBit;
+    if(magnitude > csFloatInfinity) {
+      append(csNan);
+    }
+    else if(magnitude == csFloatInfinity) {
+      append(csInf);
+    }
+    else if(magnitude == 0u) {
+      append(csNumericFill);
+    }
+    else {
+      if((bits & csFloatSignBit) != 0u) {
+        append(csMinus);
+      }
+      else if(tAlignSigned) {
+        append(csSpace);
+      }
+      else { // nothing to do
+      }
+      uint8_t const digitCount = aDigitsNeeded < IntegerFloat::csMaxDigitCount ? aDigitsNeeded : IntegerFloat::csMaxDigitCount;
+      auto const [significand, exponent] = IntegerFloat::convert(aValue, digitCount);
+      appendScientific(significand, digitCount, exponent);
+    }
+  }
+
+  /// Prints aSignificand * 10^aExponent as d.ddde+x, where aSignificand has aDigitCount digits.
+  template<typename tMagnitude>
+  void appendScientific(tMagnitude const aSignificand, uint8_t const aDigitCount, int32_t const aExponent) noexcept {
+    char digits[csMaxDigitCountShortest];
+    writeDigits(digits, aSignificand, tMagnitude{10u}, aDigitCount);
+    append(digits[0]);
+    if(aDigitCount > 1u) {
+      append(csFractionDot);
+      for(uint8_t i = 1u; i < aDigitCount; ++i) {
+        append(digits[i]);
+      }
+    }
+    else { // nothing to do
+    }
+    int32_t const exponent = aExponent + aDigitCount - 1;
+    append(csScientificE);
+    if(exponent >= 0) {
+      append(csPlus);
+    }
+    else { // nothing to do
     }
-    append(tmpBuffer[0]);
+    append(exponent, static_cast<int32_t>(10), 0u);
   }
 
   void append(long double const aValue, uint8_t const aDigitsNeeded) noexcept {
@@ -0,0 +1,464 @@
+#ifndef NOWTECH_LOG_CONVERTER_JSON_LINES
+#define NOWTECH_LOG_CONVERTER_JSON_LINES
+
+#include "LogConverterCustomText.h"
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace nowtech::log {
+
+/// Independent of STL
+/// Renders each group as one JSON object on a line of its own, like
+/// {"task":"main","time":1234,"topic":"net","items":["sent",42,0.5]}
+/// The header fields are recognized by their marks in the fill, the task id by
+/// LogFormat::asTaskId(), the time by LogFormat::asTimestamp(), the names by
+/// LogFormat::csFillValueTaskName and LogFormat::csFillValueTopic. Lines without a
+/// header have the items only. Numbers are formatted by ConverterCustomText, decimal
+/// integers without fill. What is no valid JSON number, like hexadecimal values or
+/// nan, becomes a string. Values are written whole or not at all, except strings,
+/// which are truncated. Either way the object is closed, as space for it is kept.
+template<typename tMessage, bool tArchitecture64, uint8_t tAppendStackBufferSize, bool tShortestFloat = false, bool tIntegerFloat = false>
+class ConverterJsonLines final {
+public:
+  using tMessage_          = tMessage;
+  using ConversionResult   = char;
+  using Iterator           = char*;
+  static constexpr Iterator csNullIterator = nullptr; // Used in SenderVoid to return void begin-end pair.
+  static constexpr bool     csSupportFloatingPoint = tMessage::csSupportFloatingPoint;
+  static constexpr bool     csWholeLines = true;   // Each line must be converted by one instance.
+
+private:
+  using TextConverter = ConverterCustomText<tMessage, tArchitecture64, tAppendStackBufferSize, true, false, tShortestFloat, tIntegerFloat>;
+
+  enum class Field : uint8_t {
+    cItem, cTask, cTime, cTopic
+  };
+
+  enum class StringState : uint8_t {
+    cNone, cOpen, cDropped
+  };
+
+  static constexpr size_t  csReserve          = 16u;   // Closing quote, then ',"items":[]}' and the end of line.
+  static constexpr size_t  csNumberBufferSize = 96u;   // 64 binary digits with prefix and fill.
+  static constexpr size_t  csMaxPreambleSize  = 16u;
+  static constexpr size_t  csUnicodeEscapeSize = 6u;
+  static constexpr uint8_t csDecimal          = 10u;
+
+  static constexpr char csQuote         = '"';
+  static constexpr char csBackslash     = '\\';
+  static constexpr char csComma         = ',';
+  static constexpr char csObjectBegin   = '{';
+  static constexpr char csObjectEnd     = '}';
+  static constexpr char csArrayEnd      = ']';
+  static constexpr char csEndOfLine     = '\n';
+  static constexpr char csMinus         = '-';
+  static constexpr char csPlus          = '+';
+  static constexpr char csFractionDot   = '.';
+  static constexpr char csUnicodeEscape = 'u';
+
+  inline static constexpr char csKeyTask[]  = "\"task\":";
+  inline static constexpr char csKeyTime[]  = "\"time\":";
+  inline static constexpr char csKeyTopic[] = "\"topic\":";
+  inline static constexpr char csKeyItems[] = "\"items\":[";
+  inline static constexpr char csTrue[]     = "true";
+  inline static constexpr char csFalse[]    = "false";
+  inline static constexpr char csHexDigits[] = "0123456789abcdef";
+
+  /// 0 for characters copied as they are, otherwise the letter after the backslash.
+  struct EscapeTable final {
+    char mEscapes[256u];
+
+    constexpr EscapeTable() noexcept : mEscapes{} {
+      for(uint32_t i = 0u; i < 0x20u; ++i) {
+        mEscapes[i] = csUnicodeEscape;
+      }
+      mEscapes[static_cast<uint8_t>('\b')] = 'b';
+      mEscapes[static_cast<uint8_t>('\f')] = 'f';
+      mEscapes[static_cast<uint8_t>('\n')] = 'n';
+      mEscapes[static_cast<uint8_t>('\r')] = 'r';
+      mEscapes[static_cast<uint8_t>('\t')] = 't';
+      mEscapes[static_cast<uint8_t>(csQuote)] = csQuote;
+      mEscapes[static_cast<uint8_t>(csBackslash)] = csBackslash;
+    }
+  };
+
+  inline static constexpr EscapeTable csEscapes{};
+
+  Iterator       mBegin;
+  Iterator const mLimit;
+  Iterator const mEnd;
+  bool           mObjectOpen = false;
+  bool           mHasMembers = false;
+  bool           mItemsOpen  = false;
+  bool           mHasItems   = false;
+  StringState    mStringState = StringState::cNone;
+
+public:
+  ConverterJsonLines(Iterator aBegin, Iterator const aEnd) noexcept
+  : mBegin(aBegin)
+  , mLimit(aEnd - aBegin > static_cast<ptrdiff_t>(csReserve) ? aEnd - csReserve : aBegin)
+  , mEnd(aEnd) {
+  }
+
+  ConverterJsonLines(ConverterJsonLines const &) = delete;
+  ConverterJsonLines(ConverterJsonLines &&) = delete;
+  ConverterJsonLines& operator=(ConverterJsonLines const &) = delete;
+  ConverterJsonLines& operator=(ConverterJsonLines &&) = delete;
+
+  Iterator end() const noexcept {
+    return mBegin;
+  }
+
+  void convert(ShutdownMessageContent const, uint8_t const, uint8_t const) noexcept { // nothing to do
+  }
+
+  template <typename tDummy = void>
+  auto convert(float const aValue, uint8_t const aBase, uint8_t const aFill) noexcept -> std::enable_if_t<csSupportFloatingPoint, tDummy> {
+    appendNumber(Field::cItem, aValue, aBase, aFill);
+  }
+
+  template <typename tDummy = void>
+  auto convert(double const aValue, uint8_t const aBase, uint8_t const aFill) noexcept -> std::enable_if_t<csSupportFloatingPoint, tDummy> {
+    appendNumber(Field::cItem, aValue, aBase, aFill);
+  }
+
+  template <typename tDummy = void>
+  auto convert(long double const aValue, uint8_t const aBase, uint8_t const aFill) noexcept -> std::enable_if_t<csSupportFloatingPoint, tDummy> {
+    appendNumber(Field::cItem, aValue, aBase, aFill);
+  }
+
+  void convert(uint8_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendInteger(aValue, aBase, aFill);
+  }
+
+  void convert(uint16_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendInteger(aValue, aBase, aFill);
+  }
+
+  void convert(uint32_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendInteger(aValue, aBase, aFill);
+  }
+
+  void convert(uint64_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendInteger(aValue, aBase, aFill);
+  }
+
+  void convert(int8_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendInteger(aValue, aBase, aFill);
+  }
+
+  void convert(int16_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendInteger(aValue, aBase, aFill);
+  }
+
+  void convert(int32_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendInteger(aValue, aBase, aFill);
+  }
+
+  void convert(int64_t const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    appendInteger(aValue, aBase, aFill);
+  }
+
+  void convert(char const aValue, uint8_t const, uint8_t const) noexcept {
+    char const text[2u] = { aValue, 0 };
+    appendString(Field::cItem, text, false);
+  }
+
+  void convert(char const * const aValue, uint8_t const, uint8_t const aFill) noexcept {
+    appendString(getStringField(aFill), aValue, false);
+  }
+
+  void convert(bool const aValue, uint8_t const, uint8_t const) noexcept {
+    char const * const text = aValue ? csTrue : csFalse;
+    size_t const length = std::strlen(text);
+    if(beginValue(Field::cItem, length)) {
+      std::memcpy(mBegin, text, length);
+      mBegin += length;
+    }
+    else { // nothing to do
+    }
+  }
+
+  void convert(char const * const aValue, uint8_t const aFill) noexcept {   // extra function for MessageCompact
+    appendString(getStringField(aFill), aValue, LogFormat::isStringContinued(aFill));
+  }
+
+  void convert(std::array<char, tMessage::csPayloadSize> const &aValue, uint8_t const, uint8_t const aFill) noexcept {
+    convert(aValue.data(), aFill);
+  }
+
+  void terminateSequence() noexcept {
+    if(mStringState == StringState::cOpen) {
+      append(csQuote);
+      mStringState = StringState::cNone;
+    }
+    else { // nothing to do
+    }
+    if(!mObjectOpen) {
+      append(csObjectBegin);
+    }
+    else { // nothing to do
+    }
+    if(!mItemsOpen) {
+      if(mHasMembers) {
+        append(csComma);
+      }
+      else { // nothing to do
+      }
+      append(csKeyItems);
+    }
+    else { // nothing to do
+    }
+    append(csArrayEnd);
+    append(csObjectEnd);
+    append(csEndOfLine);
+  }
+
+private:
+  /// Only for the closing characters, which have the reserved space.
+  void append(char const aValue) noexcept {
+    if(mBegin < mEnd) {
+      *mBegin = aValue;
+      ++mBegin;
+    }
+    else { // nothing to do
+    }
+  }
+
+  void append(char const * const aValue) noexcept {
+    char const * where = aValue;
+    while(*where && mBegin < mEnd) {
+      *mBegin = *where;
+      ++mBegin;
+      ++where;
+    }
+  }
+
+  static Field getStringField(uint8_t const aFill) noexcept {
+    Field result;
+    if(LogFormat::isTaskName(aFill)) {
+      result = Field::cTask;
+    }
+    else if(aFill == LogFormat::csFillValueTopic) {
+      result = Field::cTopic;
+    }
+    else {
+      result = Field::cItem;
+    }
+    return result;
+  }
+
+  static void copy(char * const aDestination, size_t &aSize, char const * const aText) noexcept {
+    size_t const length = std::strlen(aText);
+    std::memcpy(aDestination + aSize, aText, length);
+    aSize += length;
+  }
+
+  /// Writes the separator and the key if aValueSize characters fit after them.
+  /// Header fields after the first item are kept as items.
+  bool beginValue(Field const aField, size_t const aValueSize) noexcept {
+    char preamble[csMaxPreambleSize];
+    size_t size = 0u;
+    if(!mObjectOpen) {
+      preamble[size] = csObjectBegin;
+      ++size;
+    }
+    else { // nothing to do
+    }
+    bool const item = aField == Field::cItem || mItemsOpen;
+    if((item && mHasItems) || (!mItemsOpen && mHasMembers)) {
+      preamble[size] = csComma;
+      ++size;
+    }
+    else { // nothing to do
+    }
+    if(item) {
+      if(!mItemsOpen) {
+        copy(preamble, size, csKeyItems);
+      }
+      else { // nothing to do
+      }
+    }
+    else if(aField == Field::cTask) {
+      copy(preamble, size, csKeyTask);
+    }
+    else if(aField == Field::cTime) {
+      copy(preamble, size, csKeyTime);
+    }
+    else {
+      copy(preamble, size, csKeyTopic);
+    }
+    bool const result = static_cast<size_t>(mLimit - mBegin) >= size + aValueSize;
+    if(result) {
+      std::memcpy(mBegin, preamble, size);
+      mBegin += size;
+      mObjectOpen = true;
+      mHasMembers = true;
+      mItemsOpen = item;
+      mHasItems = item;
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// Transient strings may come in chunks, all but the last one with aContinued.
+  void appendString(Field const aField, char const * const aValue, bool const aContinued) noexcept {
+    if(mStringState == StringState::cNone) {
+      if(beginValue(aField, 2u)) {
+        *mBegin = csQuote;
+        ++mBegin;
+        mStringState = StringState::cOpen;
+      }
+      else {
+        mStringState = StringState::cDropped;
+      }
+    }
+    else { // nothing to do
+    }
+    if(mStringState == StringState::cOpen) {
+      appendEscaped(aValue);
+      if(!aContinued) {
+        *mBegin = csQuote;    // beginValue or the reserve left space for it.
+        ++mBegin;
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    if(!aContinued) {
+      mStringState = StringState::cNone;
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Truncates at the limit, but never inside an escape sequence.
+  void appendEscaped(char const * const aValue) noexcept {
+    char const * where = aValue;
+    bool room = true;
+    while(room && *where != 0 && mBegin < mLimit) {
+      uint8_t const character = static_cast<uint8_t>(*where);
+      char const escape = csEscapes.mEscapes[character];
+      if(escape == 0) {
+        *mBegin = *where;
+        ++mBegin;
+      }
+      else if(escape != csUnicodeEscape) {
+        room = mLimit - mBegin >= 2;
+        if(room) {
+          mBegin[0] = csBackslash;
+          mBegin[1] = escape;
+          mBegin += 2;
+        }
+        else { // nothing to do
+        }
+      }
+      else {
+        room = mLimit - mBegin >= static_cast<ptrdiff_t>(csUnicodeEscapeSize);
+        if(room) {
+          mBegin[0] = csBackslash;
+          mBegin[1] = csUnicodeEscape;
+          mBegin[2] = '0';
+          mBegin[3] = '0';
+          mBegin[4] = csHexDigits[character >> 4u];
+          mBegin[5] = csHexDigits[character & 0x0fu];
+          mBegin += csUnicodeEscapeSize;
+        }
+        else { // nothing to do
+        }
+      }
+      ++where;
+    }
+  }
+
+  /// Decimal values need no fill in JSON, and it would make them invalid numbers.
+  template<typename tValue>
+  void appendInteger(tValue const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    Field field;
+    if(LogFormat::isTimestamp(aFill)) {
+      field = Field::cTime;
+    }
+    else if(LogFormat::isTaskId(aFill)) {
+      field = Field::cTask;
+    }
+    else {
+      field = Field::cItem;
+    }
+    appendNumber(field, aValue, aBase, aBase == csDecimal ? 0u : LogFormat::getIntegerFill(aFill));
+  }
+
+  template<typename tValue>
+  void appendNumber(Field const aField, tValue const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    char buffer[csNumberBufferSize];
+    TextConverter text(buffer, buffer + csNumberBufferSize);
+    text.convert(aValue, aBase, aFill);
+    size_t const length = static_cast<size_t>(text.end() - buffer) - 1u;   // Without the space.
+    bool const quoted = !isJsonNumber(buffer, length);
+    if(beginValue(aField, length + (quoted ? 2u : 0u))) {
+      if(quoted) {
+        *mBegin = csQuote;
+        ++mBegin;
+      }
+      else { // nothing to do
+      }
+      std::memcpy(mBegin, buffer, length);
+      mBegin += length;
+      if(quoted) {
+        *mBegin = csQuote;
+        ++mBegin;
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  static bool isDigit(char const aCharacter) noexcept {
+    return aCharacter >= '0' && aCharacter <= '9';
+  }
+
+  static size_t skipDigits(char const * const aText, size_t const aLength, size_t const aPosition) noexcept {
+    size_t result = aPosition;
+    while(result < aLength && isDigit(aText[result])) {
+      ++result;
+    }
+    return result;
+  }
+
+  /// Checks the JSON number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+  static bool isJsonNumber(char const * const aText, size_t const aLength) noexcept {
+    size_t position = (aLength > 0u && aText[0] == csMinus) ? 1u : 0u;
+    size_t const integerBegin = position;
+    position = skipDigits(aText, aLength, position);
+    bool result = position > integerBegin && (aText[integerBegin] != '0' || position == integerBegin + 1u);
+    if(result && position < aLength && aText[position] == csFractionDot) {
+      size_t const fractionBegin = position + 1u;
+      position = skipDigits(aText, aLength, fractionBegin);
+      result = position > fractionBegin;
+    }
+    else { // nothing to do
+    }
+    if(result && position < aLength && (aText[position] == 'e' || aText[position] == 'E')) {
+      ++position;
+      if(position < aLength && (aText[position] == csPlus || aText[position] == csMinus)) {
+        ++position;
+      }
+      else { // nothing to do
+      }
+      size_t const exponentBegin = position;
+      position = skipDigits(aText, aLength, exponentBegin);
+      result = position > exponentBegin;
+    }
+    else { // nothing to do
+    }
+    return result && position == aLength;
+  }
+};
+
+}
+
+#endif
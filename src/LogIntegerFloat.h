@@ -0,0 +1,221 @@
+#ifndef NOWTECH_LOG_INTEGER_FLOAT
+#define NOWTECH_LOG_INTEGER_FLOAT
+
+#include <cstdint>
+#include <cstring>
+
+namespace nowtech::log {
+
+/// Decimal representation of float values with a given number of significant
+/// digits or decimals, working only on the IEEE 754 bit pattern with 32 and 64
+/// bit integer arithmetic. This needs no floating point unit and no libm, so
+/// targets without an FPU avoid the soft-float log10 and pow emulation.
+/// The value is multiplied by a 64-bit normalized power of 10 and rounded half up.
+/// The result can only differ from the correctly rounded one if the value is within
+/// about 2^-60 relative distance of a halfway point.
+/// Independent of STL. The table takes 93 * 8 bytes of read-only memory.
+class IntegerFloat final {
+public:
+  static constexpr uint8_t csMaxDigitCount = 9u;
+
+  /// The value is aSignificand * 10^aExponent, the sign is left to the caller.
+  /// The significand has exactly the requested number of digits.
+  struct Decimal final {
+    uint32_t mSignificand;
+    int32_t  mExponent;
+  };
+
+  IntegerFloat() = delete;
+
+  /// Only for finite non-zero values, aDigitCount in [1, csMaxDigitCount].
+  static Decimal convert(float const aValue, uint8_t const aDigitCount) noexcept {
+    auto [c, q] = decode(aValue);
+    // Now aValue = c * 2^q with c in [2^23, 2^24), so its decimal exponent is this or one more.
+    int32_t exponent = flog10pow2(q + csPrecision - 1);
+    uint32_t const limit = csPowersOf10[aDigitCount];
+    uint32_t significand = scale(c, q, aDigitCount - 1 - exponent);
+    if(significand >= limit) {
+      ++exponent;
+      significand = scale(c, q, aDigitCount - 1 - exponent);
+    }
+    else { // nothing to do
+    }
+    return Decimal{significand, exponent - (aDigitCount - 1)};
+  }
+
+  /// Only for finite non-zero values, aDecimals in [0, csMaxDigitCount].
+  /// @return false if aValue * 10^aDecimals rounded half up might need more than csMaxDigitCount digits.
+  static bool convertFixed(float const aValue, uint8_t const aDecimals, uint32_t &aScaled) noexcept {
+    auto [c, q] = decode(aValue);
+    int32_t const exponent = flog10pow2(q + csPrecision - 1);
+    bool result = true;
+    if(exponent + 1 + aDecimals > csMaxDigitCount) {
+      result = false;
+    }
+    else if(exponent + aDecimals < -1) {   // Below 0.1 after scaling, which also keeps the shift in scale() in range.
+      aScaled = 0u;
+    }
+    else {
+      aScaled = scale(c, q, aDecimals);
+    }
+    return result;
+  }
+
+private:
+  static constexpr int32_t  csPrecision    = 24;
+  static constexpr int32_t  csMinQ         = -149;
+  static constexpr uint32_t csHiddenBit    = uint32_t{1u} << (csPrecision - 1);
+  static constexpr uint32_t csExponentMask = 0xffu;
+  static constexpr int32_t  csMinK         = -39;
+  static constexpr uint64_t csMask32       = (uint64_t{1u} << 32u) - 1u;
+
+  struct Binary final {
+    uint32_t mSignificand;
+    int32_t  mExponent;
+  };
+
+  /// @return c and q with aValue = c * 2^q and c in [2^23, 2^24), subnormals normalized.
+  static Binary decode(float const aValue) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &aValue, sizeof(bits));
+    uint32_t c = bits & (csHiddenBit - 1u);
+    int32_t const biasedExponent = static_cast<int32_t>((bits >> (csPrecision - 1)) & csExponentMask);
+    int32_t q;
+    if(biasedExponent != 0) {
+      c |= csHiddenBit;
+      q = biasedExponent + csMinQ - 1;
+    }
+    else {
+      q = csMinQ;
+      while(c < csHiddenBit) {
+        c <<= 1u;
+        --q;
+      }
+    }
+    return Binary{c, q};
+  }
+
+  /// floor(aE * log10(2)) for |aE| <= 1650
+  static constexpr int32_t flog10pow2(int32_t const aE) noexcept {
+    return (aE * 78913) >> 18;
+  }
+
+  /// floor(aE * log2(10)) for |aE| <= 1233
+  static constexpr int32_t flog2pow10(int32_t const aE) noexcept {
+    return (aE * 1741647) >> 19;
+  }
+
+  /// @return aC * 2^aQ * 10^aK rounded half up, which must be below 2^32.
+  static uint32_t scale(uint32_t const aC, int32_t const aQ, int32_t const aK) noexcept {
+    uint64_t const power = csPowers[aK - csMinK];
+    // The product has at most 88 bits, of which the lowest 32 can be dropped.
+    uint64_t const product = aC * (power >> 32u) + ((aC * (power & csMask32)) >> 32u);
+    int32_t const shift = 63 - 32 - aQ - flog2pow10(aK);
+    return static_cast<uint32_t>(((product >> (shift - 1)) + 1u) >> 1u);
+  }
+
+  inline static constexpr uint32_t csPowersOf10[] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+  };
+
+  /// 10^k normalized to [2^63, 2^64) and rounded, for k in [csMinK, 53].
+  inline static constexpr uint64_t csPowers[] = {
+    0xae397d8aa96c1b78u, // -39
+    0xd9c7dced53c72256u, // -38
+    0x881cea14545c7575u, // -37
+    0xaa242499697392d3u, // -36
+    0xd4ad2dbfc3d07788u, // -35
+    0x84ec3c97da624ab5u, // -34
+    0xa6274bbdd0fadd62u, // -33
+    0xcfb11ead453994bau, // -32
+    0x81ceb32c4b43fcf5u, // -31
+    0xa2425ff75e14fc32u, // -30
+    0xcad2f7f5359a3b3eu, // -29
+    0xfd87b5f28300ca0eu, // -28
+    0x9e74d1b791e07e48u, // -27
+    0xc612062576589ddbu, // -26
+    0xf79687aed3eec551u, // -25
+    0x9abe14cd44753b53u, // -24
+    0xc16d9a0095928a27u, // -23
+    0xf1c90080baf72cb1u, // -22
+    0x971da05074da7befu, // -21
+    0xbce5086492111aebu, // -20
+    0xec1e4a7db69561a5u, // -19
+    0x9392ee8e921d5d07u, // -18
+    0xb877aa3236a4b449u, // -17
+    0xe69594bec44de15bu, // -16
+    0x901d7cf73ab0acd9u, // -15
+    0xb424dc35095cd80fu, // -14
+    0xe12e13424bb40e13u, // -13
+    0x8cbccc096f5088ccu, // -12
+    0xafebff0bcb24aaffu, // -11
+    0xdbe6fecebdedd5bfu, // -10
+    0x89705f4136b4a597u, //  -9
+    0xabcc77118461cefdu, //  -8
+    0xd6bf94d5e57a42bcu, //  -7
+    0x8637bd05af6c69b6u, //  -6
+    0xa7c5ac471b478423u, //  -5
+    0xd1b71758e219652cu, //  -4
+    0x83126e978d4fdf3bu, //  -3
+    0xa3d70a3d70a3d70au, //  -2
+    0xcccccccccccccccdu, //  -1
+    0x8000000000000000u, //   0
+    0xa000000000000000u, //   1
+    0xc800000000000000u, //   2
+    0xfa00000000000000u, //   3
+    0x9c40000000000000u, //   4
+    0xc350000000000000u, //   5
+    0xf424000000000000u, //   6
+    0x9896800000000000u, //   7
+    0xbebc200000000000u, //   8
+    0xee6b280000000000u, //   9
+    0x9502f90000000000u, //  10
+    0xba43b74000000000u, //  11
+    0xe8d4a51000000000u, //  12
+    0x9184e72a00000000u, //  13
+    0xb5e620f480000000u, //  14
+    0xe35fa931a0000000u, //  15
+    0x8e1bc9bf04000000u, //  16
+    0xb1a2bc2ec5000000u, //  17
+    0xde0b6b3a76400000u, //  18
+    0x8ac7230489e80000u, //  19
+    0xad78ebc5ac620000u, //  20
+    0xd8d726b7177a8000u, //  21
+    0x878678326eac9000u, //  22
+    0xa968163f0a57b400u, //  23
+    0xd3c21bcecceda100u, //  24
+    0x84595161401484a0u, //  25
+    0xa56fa5b99019a5c8u, //  26
+    0xcecb8f27f4200f3au, //  27
+    0x813f3978f8940984u, //  28
+    0xa18f07d736b90be5u, //  29
+    0xc9f2c9cd04674edfu, //  30
+    0xfc6f7c4045812296u, //  31
+    0x9dc5ada82b70b59eu, //  32
+    0xc5371912364ce305u, //  33
+    0xf684df56c3e01bc7u, //  34
+    0x9a130b963a6c115cu, //  35
+    0xc097ce7bc90715b3u, //  36
+    0xf0bdc21abb48db20u, //  37
+    0x96769950b50d88f4u, //  38
+    0xbc143fa4e250eb31u, //  39
+    0xeb194f8e1ae525fdu, //  40
+    0x92efd1b8d0cf37beu, //  41
+    0xb7abc627050305aeu, //  42
+    0xe596b7b0c643c719u, //  43
+    0x8f7e32ce7bea5c70u, //  44
+    0xb35dbf821ae4f38cu, //  45
+    0xe0352f62a19e306fu, //  46
+    0x8c213d9da502de45u, //  47
+    0xaf298d050e4395d7u, //  48
+    0xdaf3f04651d47b4cu, //  49
+    0x88d8762bf324cd10u, //  50
+    0xab0e93b6efee0054u, //  51
+    0xd5d238a4abe98068u, //  52
+    0x85a36366eb71f041u  //  53
+  };
+};
+
+}
+
+#endif
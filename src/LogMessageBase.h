@@ -10,6 +10,56 @@ struct LogFormat final {
 public:
   static constexpr uint8_t csFillValueStoreString = std::numeric_limits<uint8_t>::max();
   static constexpr uint8_t csFillValueStoreStringTerminal = csFillValueStoreString - 1u;
+  static constexpr uint8_t csFillValueShortest = csFillValueStoreStringTerminal - 1u;   // For floating point types only.
+  static constexpr uint8_t csFillValueStoreTaskName = csFillValueShortest - 1u;          // Like csFillValueStoreString, marks the task name in the header.
+  static constexpr uint8_t csFillValueTaskName = csFillValueStoreTaskName - 1u;          // For strings only, the task name or its last chunk.
+  static constexpr uint8_t csFillValueTopic = csFillValueTaskName - 1u;                  // For strings only, the topic in the header.
+  static constexpr uint8_t csFillValueFixed = 0x80u;           // For floating point types only, plus the count of decimals.
+  static constexpr uint8_t csMaxFixedDecimals = 9u;
+
+  static constexpr uint8_t csFillValueTimestamp = 0xa0u;       // For integer types only, plus the fill, marks the time in the header.
+  static constexpr uint8_t csMaxTimestampFill = 0x1fu;
+
+  static constexpr uint8_t csFillValueTaskId = 0xc0u;          // For integer types only, plus the fill, marks the task id in the header.
+  static constexpr uint8_t csMaxTaskIdFill = 0x1fu;
+
+  static constexpr bool isFixed(uint8_t const aFill) noexcept {
+    return aFill >= csFillValueFixed && aFill <= csFillValueFixed + csMaxFixedDecimals;
+  }
+
+  static constexpr bool isTimestamp(uint8_t const aFill) noexcept {
+    return aFill >= csFillValueTimestamp && aFill <= csFillValueTimestamp + csMaxTimestampFill;
+  }
+
+  static constexpr bool isTaskId(uint8_t const aFill) noexcept {
+    return aFill >= csFillValueTaskId && aFill <= csFillValueTaskId + csMaxTaskIdFill;
+  }
+
+  /// @return the fill of an integer without the timestamp or task id mark. Floating point formats mean no fill.
+  static constexpr uint8_t getIntegerFill(uint8_t const aFill) noexcept {
+    uint8_t result = aFill;
+    if(isTimestamp(aFill)) {
+      result = aFill - csFillValueTimestamp;
+    }
+    else if(isTaskId(aFill)) {
+      result = aFill - csFillValueTaskId;
+    }
+    else if(isFixed(aFill) || aFill == csFillValueShortest) {
+      result = 0u;
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// @return true for the chunks of a transient string except the last one, which need no space after them.
+  static constexpr bool isStringContinued(uint8_t const aFill) noexcept {
+    return aFill == csFillValueStoreString || aFill == csFillValueStoreTaskName;
+  }
+
+  static constexpr bool isTaskName(uint8_t const aFill) noexcept {
+    return aFill == csFillValueStoreTaskName || aFill == csFillValueTaskName;
+  }
 
   uint8_t mBase;
   uint8_t mFill;
@@ -23,7 +73,17 @@ public:
   }
 
   bool isStoredString() const noexcept {
-    return mFill >= csFillValueStoreString;
+    return isStringContinued(mFill);
+  }
+
+  /// The same format with the timestamp mark, so binary converters can send the difference only.
+  LogFormat asTimestamp() const noexcept {
+    return LogFormat{mBase, static_cast<uint8_t>(csFillValueTimestamp + (mFill & csMaxTimestampFill))};
+  }
+
+  /// The same format with the task id mark, so structured converters can tell the header field.
+  LogFormat asTaskId() const noexcept {
+    return LogFormat{mBase, static_cast<uint8_t>(csFillValueTaskId + (mFill & csMaxTaskIdFill))};
   }
 };
 
@@ -3,6 +3,7 @@
 #define NOWTECH_LOG_MESSAGE_COMPACT
 
 #include "LogMessageBase.h"
+#include <algorithm>
 #include <array>
 #include <cstring>
 
@@ -28,10 +29,14 @@ private:
   static constexpr size_t csOffsetTaskId          = csOffsetFill + sizeof(uint8_t);
   static constexpr size_t csOffsetMessageSequence = csOffsetTaskId + sizeof(TaskId);
   static constexpr size_t csOffsetType            = csOffsetMessageSequence + sizeof(MessageSequence);
+  static constexpr uint8_t csPriorityFlag          = 0x80u;  // Stored along the type, which needs far fewer bits.
   
   uint8_t mData[csTotalSize];
 
 public:
+  /// Upper bound of what pack writes.
+  static constexpr size_t csMaxPackedSize = csTotalSize - sizeof(TaskId) - sizeof(MessageSequence);
+
   MessageCompact() = default;
   MessageCompact(MessageCompact const &) = default;
   MessageCompact(MessageCompact &&) = default;
@@ -60,7 +65,7 @@ public:
 
   template<typename tConverter>
   void output(tConverter& aConverter) const noexcept {
-    Type type = static_cast<Type>(mData[csOffsetType]);
+    Type type = getStoredType();
     uint8_t base = mData[csOffsetBase];
     uint8_t fill = mData[csOffsetFill];
 
@@ -164,7 +169,54 @@ public:
   }
 
   bool isShutdown() const noexcept {
-    return static_cast<Type>(mData[csOffsetType]) == Type::cShutdown;
+    return getStoredType() == Type::cShutdown;
+  }
+
+  /// Marks a message of a Fatal or Error group, set may be called before only.
+  void setPriority() noexcept {
+    mData[csOffsetType] |= csPriorityFlag;
+  }
+
+  bool isPriority() const noexcept {
+    return (mData[csOffsetType] & csPriorityFlag) != 0u;
+  }
+
+  bool isStoredChars() const noexcept {
+    return getStoredType() == Type::cStoredChars;
+  }
+
+  /// Valid only if isStoredChars(). The chunk is terminated, the fill tells if the string continues.
+  char const * getStoredChars() const noexcept {
+    return reinterpret_cast<char const*>(mData + csOffsetPayload);
+  }
+
+  size_t getPackedSize() const noexcept {
+    return csPackedHeaderSize + getPayloadSize();
+  }
+
+  /// Writes the type, base and fill followed by only the payload bytes the type needs.
+  /// Task ID and sequence are omitted, variable-length queues store them once per group.
+  /// @return the number of bytes written, at most csMaxPackedSize.
+  size_t pack(uint8_t * const aDestination) const noexcept {
+    size_t const payloadSize = getPayloadSize();
+    aDestination[0] = mData[csOffsetType];
+    aDestination[1] = mData[csOffsetBase];
+    aDestination[2] = mData[csOffsetFill];
+    std::memcpy(aDestination + csPackedHeaderSize, mData + csOffsetPayload, payloadSize);
+    return csPackedHeaderSize + payloadSize;
+  }
+
+  /// Counterpart of pack.
+  /// @return the number of bytes consumed.
+  size_t unpack(uint8_t const * const aSource, TaskId const aTaskId, MessageSequence const aMessageSequence) noexcept {
+    mData[csOffsetType] = aSource[0];
+    mData[csOffsetBase] = aSource[1];
+    mData[csOffsetFill] = aSource[2];
+    mData[csOffsetTaskId] = aTaskId;
+    mData[csOffsetMessageSequence] = aMessageSequence;
+    size_t const payloadSize = getPayloadSize();
+    std::memcpy(mData + csOffsetPayload, aSource + csPackedHeaderSize, payloadSize);
+    return csPackedHeaderSize + payloadSize;
   }
 
   bool isTerminal() const noexcept {
@@ -188,6 +240,57 @@ public:
   }  
 
 private:
+  static constexpr size_t csPackedHeaderSize = 3u;
+
+  Type getStoredType() const noexcept {
+    return static_cast<Type>(mData[csOffsetType] & ~csPriorityFlag);
+  }
+
+  size_t getPayloadSize() const noexcept {
+    size_t result;
+    switch(getStoredType()) {
+    case Type::cBool:
+      result = sizeof(bool);
+      break;
+    case Type::cFloat:
+      result = sizeof(float);
+      break;
+    case Type::cDouble:
+      result = sizeof(double);
+      break;
+    case Type::cLongDouble:
+      result = sizeof(long double);
+      break;
+    case Type::cUint8_t:
+    case Type::cInt8_t:
+    case Type::cChar:
+      result = sizeof(uint8_t);
+      break;
+    case Type::cUint16_t:
+    case Type::cInt16_t:
+      result = sizeof(uint16_t);
+      break;
+    case Type::cUint32_t:
+    case Type::cInt32_t:
+      result = sizeof(uint32_t);
+      break;
+    case Type::cUint64_t:
+    case Type::cInt64_t:
+      result = sizeof(uint64_t);
+      break;
+    case Type::cCharArray:
+      result = sizeof(char*);
+      break;
+    case Type::cStoredChars:
+      result = ::strnlen(reinterpret_cast<char const*>(mData + csOffsetPayload), tPayloadSize) + 1u;
+      break;
+    default:
+      result = 0u;
+      break;
+    }
+    return std::min(result, tPayloadSize);
+  }
+
   template<typename tArgument> static Type getType(tArgument const) noexcept { return Type::cInvalid; }
   static Type getType(bool const) noexcept { return Type::cBool; }
   static Type getType(float const) noexcept { return Type::cFloat; }
@@ -39,6 +39,7 @@ private:
   LogFormat       mFormat;
   TaskId          mTaskId;
   MessageSequence mMessageSequence;
+  bool            mPriority;        // Fits in the padding.
 
 public:
   MessageVariant() = default;
@@ -58,6 +59,16 @@ public:
     mFormat = aFormat;
     mTaskId = aTaskId;
     mMessageSequence = aMessageSequence;
+    mPriority = false;
+  }
+
+  /// Marks a message of a Fatal or Error group, set may be called before only.
+  void setPriority() noexcept {
+    mPriority = true;
+  }
+
+  bool isPriority() const noexcept {
+    return mPriority;
   }
 
   template<typename tConverter>
@@ -8,11 +8,14 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 
+#include "LogQueueOverflow.h"
 #include <cstddef>
 
 namespace nowtech::log {
 
-template<typename tMessage, typename tAppInterface, size_t tQueueSize>
+/// tOverflowPolicy is an OverflowPolicy instance, see LogQueueOverflow.h.
+/// cBlock can't wait in an ISR, there it behaves like cDropNewest.
+template<typename tMessage, typename tAppInterface, size_t tQueueSize, typename tOverflowPolicy = OverflowPolicy<>>
 class QueueFreeRtos final {
 public:
   using tMessage_ = tMessage;
@@ -20,8 +23,15 @@ public:
   using LogTime = typename tAppInterface::LogTime;
 
   static constexpr size_t csQueueSize = tQueueSize;
+  static constexpr bool   csWakeable  = false; // xQueueReceive can't be interrupted, so the transmitter polls with the refresh period.
+  static constexpr bool   csGroupCommit = false;
+  static constexpr size_t csShardCount  = 1u;
 
 private:
+  static constexpr OverflowAction csOverflowAction = tOverflowPolicy::csAction;
+
+  static_assert(tOverflowPolicy::csGroupHeadroom <= tQueueSize);
+
   QueueFreeRtos() = delete;
 
   // static StaticQueue_t xStaticQueue;
@@ -44,14 +54,81 @@ public:
     return xQueueIsQueueEmptyFromISR(sQueue) == pdTRUE;
   }
 
-  static void push(tMessage const &aMessage) noexcept {
+  static bool push(tMessage const &aMessage) noexcept {
     // TODO[2024.06.07 Elliott]: Determine context (ISR or not)
-    xQueueSendFromISR(sQueue, &aMessage, nullptr); // Don't care about the result, pop logic will manage missing messages.
+    bool result;
+    if constexpr(csOverflowAction == OverflowAction::cDropOldest) {
+      // Another producer may fill the freed slot first, then this message is lost after all.
+      if(xQueueIsQueueFullFromISR(sQueue) == pdTRUE) {
+        tMessage oldest;
+        xQueueReceiveFromISR(sQueue, &oldest, nullptr);
+        if(!tOverflowPolicy::isEvictable(oldest)) {
+          tMessage next;
+          if(xQueueReceiveFromISR(sQueue, &next, nullptr) == pdTRUE && !tOverflowPolicy::isEvictable(next)) {
+            xQueueSendToFrontFromISR(sQueue, &next, nullptr);   // No room then, this message is lost.
+          }
+          else { // nothing to do
+          }
+          xQueueSendToFrontFromISR(sQueue, &oldest, nullptr);
+        }
+        else { // nothing to do
+        }
+      }
+      else { // nothing to do
+      }
+      result = xQueueSendFromISR(sQueue, &aMessage, nullptr) == pdTRUE;
+    }
+    else if constexpr(csOverflowAction == OverflowAction::cBlock) {
+      if(aMessage.getTaskId() == tAppInterface::csIsrTaskId) {  // Messages logged from ISRs carry this.
+        result = xQueueSendFromISR(sQueue, &aMessage, nullptr) == pdTRUE;
+      }
+      else {
+        result = xQueueSend(sQueue, &aMessage, pdMS_TO_TICKS(tOverflowPolicy::csBlockTimeout)) == pdTRUE;
+      }
+    }
+    else if constexpr(csOverflowAction == OverflowAction::cRejectGroup) {
+      if(tQueueSize - uxQueueMessagesWaitingFromISR(sQueue) >= tOverflowPolicy::requiredFree(aMessage)) {
+        result = xQueueSendFromISR(sQueue, &aMessage, nullptr) == pdTRUE;
+      }
+      else {
+        result = false;
+      }
+    }
+    else {
+      result = xQueueSendFromISR(sQueue, &aMessage, nullptr) == pdTRUE;
+    }
+    return result;  // Log stops sending the rest of the group on false.
+  }
+
+  /// FreeRTOS has no bulk send, so this stops at the first failing one.
+  static bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+    size_t pushed = 0u;
+    while(pushed < aCount && push(aMessages[pushed])) {
+      ++pushed;
+    }
+    return pushed == aCount;
   }
 
   static bool pop(tMessage &aMessage, LogTime const aPauseLength) noexcept {
     return xQueueReceive(sQueue, &aMessage, aPauseLength) == pdTRUE;
   }
+
+  /// Only the first receive waits, the rest takes what is already there.
+  static size_t popBatch(tMessage * const aMessages, size_t const aMaxCount, LogTime const aPauseLength) noexcept {
+    size_t result = 0u;
+    if(aMaxCount > 0u && xQueueReceive(sQueue, aMessages, aPauseLength) == pdTRUE) {
+      result = 1u;
+      while(result < aMaxCount && xQueueReceive(sQueue, aMessages + result, 0u) == pdTRUE) {
+        ++result;
+      }
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  static void wakeup() noexcept { // nothing to do
+  }
 };
 
 }
@@ -0,0 +1,55 @@
+#ifndef NOWTECH_LOG_QUEUE_OVERFLOW
+#define NOWTECH_LOG_QUEUE_OVERFLOW
+
+#include "LogMessageBase.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace nowtech::log {
+
+enum class OverflowAction : uint8_t {
+  cDropNewest,   // The message being pushed is lost.
+  cDropOldest,   // The oldest message in the queue makes room for the new one.
+  cBlock,        // The producer waits at most csBlockTimeout for room, then drops the message.
+  cRejectGroup   // A group is admitted at its first pushed message only if csGroupHeadroom slots are free.
+};
+
+/// Compile-time overflow behaviour of the queues which accept it as template parameter.
+/// Log stops pushing the rest of a group once a push fails, so the slots are not
+/// spent on messages the transmitter would throw away on the sequence gap anyway.
+/// @param tBlockTimeout in ms, only for cBlock.
+/// @param tGroupHeadroom only for cRejectGroup, should be about the message count of a typical group.
+template<OverflowAction tAction = OverflowAction::cDropNewest, uint32_t tBlockTimeout = 0u, size_t tGroupHeadroom = 1u>
+struct OverflowPolicy final {
+  static constexpr OverflowAction csAction        = tAction;
+  static constexpr uint32_t       csBlockTimeout  = tBlockTimeout;
+  static constexpr size_t         csGroupHeadroom = tGroupHeadroom;
+
+  static_assert(tGroupHeadroom > 0u);
+
+  /// Log sends the message with sequence 0 last, so the first one arriving at the queue has 1.
+  /// Groups consisting only of the sequence 0 message need just one free slot.
+  template<typename tMessage>
+  static bool isGroupStart(tMessage const &aMessage) noexcept {
+    return !aMessage.isShutdown() && aMessage.getMessageSequence() == csGroupStartSequence;
+  }
+
+  /// Free slots needed to admit the message.
+  template<typename tMessage>
+  static size_t requiredFree(tMessage const &aMessage) noexcept {
+    return (csAction == OverflowAction::cRejectGroup && isGroupStart(aMessage)) ? csGroupHeadroom : 1u;
+  }
+
+  /// cDropOldest must not evict shutdown messages, because the unregistering task waits for them.
+  template<typename tMessage>
+  static bool isEvictable(tMessage const &aMessage) noexcept {
+    return !aMessage.isShutdown();
+  }
+
+private:
+  static constexpr MessageSequence csGroupStartSequence = 1u;
+};
+
+}
+
+#endif
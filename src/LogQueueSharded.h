@@ -0,0 +1,118 @@
+#ifndef LOG_QUEUE_SHARDED
+#define LOG_QUEUE_SHARDED
+
+#include "LogMessageBase.h"
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace nowtech::log {
+
+/// Splits the messages among tShardCount instances of an STL queue by TaskId.
+/// Log starts a transmitter task for each shard. All messages of a task go
+/// to the same shard, so its groups keep their order, while groups of
+/// different tasks may overtake each other.
+/// tQueue is QueueStdCircular, QueueStdMpsc, QueueStdBoost, QueueStdGroup or
+/// QueueStdByteRing, its size applies to each shard.
+template<typename tQueue, size_t tShardCount>
+class QueueSharded final {
+public:
+  using tMessage_ = typename tQueue::tMessage_;
+  using tAppInterface_ = typename tQueue::tAppInterface_;
+  using LogTime = typename tQueue::LogTime;
+
+  static constexpr size_t csQueueSize   = tQueue::csQueueSize;
+  static constexpr bool   csWakeable    = tQueue::csWakeable;
+  static constexpr bool   csGroupCommit = tQueue::csGroupCommit;
+  static constexpr size_t csShardCount  = tShardCount;
+
+private:
+  using tMessage = tMessage_;
+  using Shard = typename tQueue::Shard;
+
+  static_assert(tShardCount > 0u);
+  static_assert(tQueue::csShardCount == 1u);
+
+  static constexpr size_t getMaxGroupSize() noexcept {
+    if constexpr(csGroupCommit) {
+      return tQueue::csMaxGroupSize;
+    }
+    else {
+      return 1u;
+    }
+  }
+
+  inline static std::array<Shard, tShardCount> sShards;
+
+  QueueSharded() = delete;
+
+public:
+  static constexpr size_t csMaxGroupSize = getMaxGroupSize();
+
+  static void init() { // nothing to do
+  }
+
+  static void done() {  // nothing to do
+  }
+
+  static size_t getShard(TaskId const aTaskId) noexcept {
+    return aTaskId % tShardCount;
+  }
+
+  static bool empty() noexcept {
+    bool result = true;
+    for(auto const &shard : sShards) {
+      if(!shard.empty()) {
+        result = false;
+        break;
+      }
+      else { // nothing to do
+      }
+    }
+    return result;
+  }
+
+  static bool empty(size_t const aShard) noexcept {
+    return sShards[aShard].empty();
+  }
+
+  static bool push(tMessage const &aMessage) noexcept {
+    bool result;
+    if constexpr(csGroupCommit) {
+      result = pushGroup(&aMessage, 1u);
+    }
+    else {
+      result = pushBatch(&aMessage, 1u);
+    }
+    return result;
+  }
+
+  /// All the messages must have the same TaskId.
+  static bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+    return sShards[getShard(aMessages[0].getTaskId())].pushBatch(aMessages, aCount);
+  }
+
+  static bool pushGroup(tMessage const * const aMessages, size_t const aCount) noexcept {
+    return sShards[getShard(aMessages[0].getTaskId())].pushGroup(aMessages, aCount);
+  }
+
+  static size_t popBatch(tMessage * const aMessages, size_t const aMaxCount, LogTime const aPauseLength, size_t const aShard) noexcept {
+    return sShards[aShard].popBatch(aMessages, aMaxCount, aPauseLength);
+  }
+
+  template<typename tVisitor>
+  static size_t popGroup(tVisitor &&aVisitor, LogTime const aPauseLength, size_t const aShard) noexcept {
+    return sShards[aShard].popGroup(std::forward<tVisitor>(aVisitor), aPauseLength);
+  }
+
+  /// Wakes the transmitters of all shards.
+  static void wakeup() noexcept {
+    for(auto &shard : sShards) {
+      shard.wakeup();
+    }
+  }
+};
+
+}
+
+#endif
@@ -1,9 +1,8 @@
 #ifndef LOG_QUEUE_STD_BOOST
 #define LOG_QUEUE_STD_BOOST
 
+#include "LogWakeupStd.h"
 #include <cstddef>
-#include <mutex>
-#include <condition_variable>
 #include <boost/lockfree/queue.hpp>
 
 namespace nowtech::log {
@@ -16,21 +15,20 @@ public:
   using LogTime = typename tAppInterface::LogTime;
 
   static constexpr size_t csQueueSize = tQueueSize;
+  static constexpr bool   csWakeable  = true;
+  static constexpr bool   csGroupCommit = false;
+  static constexpr size_t csShardCount  = 1u;
 
 private:
+  using Wakeup = WakeupStd<LogTime>;
+
   class FreeRtosQueue final {
     boost::lockfree::queue<tMessage, boost::lockfree::capacity<tQueueSize>> mQueue;
-    std::atomic<bool>                mNotified;
-    std::mutex                       mMutex;
-    std::unique_lock<std::mutex>     mLock;
-    std::condition_variable          mConditionVariable;
+    Wakeup                           mWakeup;
 
   public:
     /// First implementation, we assume we have plenty of memory.
-    FreeRtosQueue() noexcept
-      : mLock(mMutex) {
-      mNotified = false;
-    }
+    FreeRtosQueue() noexcept = default;
 
     ~FreeRtosQueue() noexcept = default;
 
@@ -38,31 +36,34 @@ private:
       return mQueue.empty();
     }
 
-    void push(tMessage const &aMessage) noexcept {
-      bool success = mQueue.bounded_push(aMessage);
-      if(success) {
-        mNotified = true;         // Having no lock_guard here makes tremendous speedup.
-        mConditionVariable.notify_one();
+    /// The lock-free queue has no bulk push, so this stops at the first failing one.
+    bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+      size_t pushed = 0u;
+      while(pushed < aCount && mQueue.bounded_push(aMessages[pushed])) {
+        ++pushed;
+      }
+      bool const success = (pushed == aCount);
+      if(pushed > 0u) {
+        mWakeup.notify();   // Syscall only if the consumer is parked.
       }
       else { // nothing to do
       }
+      return success;
     }
 
-    bool pop(tMessage &aMessage, LogTime const mPauseLength) noexcept {
-      bool result;
+    size_t popBatch(tMessage * const aMessages, size_t const aMaxCount, LogTime const aPauseLength) noexcept {
+      size_t result = 0u;
       // Safe to call empty because there will be only one consumer.
-      if(mQueue.empty() &&
-        (!mConditionVariable.wait_for(mLock, std::chrono::milliseconds(mPauseLength), [this]{return mNotified == true;})
-        && !mNotified )) {  // This check makes the lock_guard on notifying unnecessary,
-        // because I don't care if I get in right during waiting or just at the beginning of next check.
-        result = false;
-      }
-      else {
-        mNotified = false;
-        result = mQueue.pop(aMessage);
+      mWakeup.wait([this]{ return !mQueue.empty(); }, aPauseLength);
+      while(result < aMaxCount && mQueue.pop(aMessages[result])) {
+        ++result;
       }
       return result;
     }
+
+    void wakeup() noexcept {
+      mWakeup.wakeup();
+    }
   };
 
   inline static FreeRtosQueue sQueue;
@@ -70,6 +71,8 @@ private:
   QueueStdBoost() = delete;
 
 public:
+  using Shard = FreeRtosQueue;   // For QueueSharded.
+
   static void init() { // nothing to do
   }
 
@@ -80,12 +83,24 @@ public:
     return sQueue.empty();
   }
 
-  static void push(tMessage const &aMessage) noexcept {
-    sQueue.push(aMessage);
+  static bool push(tMessage const &aMessage) noexcept {
+    return sQueue.pushBatch(&aMessage, 1u);
+  }
+
+  static bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+    return sQueue.pushBatch(aMessages, aCount);
   }
 
   static bool pop(tMessage &aMessage, LogTime const aPauseLength) noexcept {
-    return sQueue.pop(aMessage, aPauseLength);
+    return sQueue.popBatch(&aMessage, 1u, aPauseLength) > 0u;
+  }
+
+  static size_t popBatch(tMessage * const aMessages, size_t const aMaxCount, LogTime const aPauseLength) noexcept {
+    return sQueue.popBatch(aMessages, aMaxCount, aPauseLength);
+  }
+
+  static void wakeup() noexcept {
+    sQueue.wakeup();
   }
 };
 
@@ -0,0 +1,324 @@
+#ifndef LOG_QUEUE_STD_BYTE_RING
+#define LOG_QUEUE_STD_BYTE_RING
+
+#include "LogMessageBase.h"
+#include "LogWakeupStd.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace nowtech::log {
+
+/// Multi-producer single-consumer group queue storing variable-length records
+/// instead of fixed message slots. A group becomes one record holding its task
+/// ID once, then each argument packed as type, base, fill and only the payload
+/// bytes it needs. The chunks of a transient string are joined into a single
+/// string item. Reservation and publishing work as in QueueStdGroup, the ring
+/// is just counted in 8-byte units.
+/// tMessage must provide pack and unpack, as MessageCompact does.
+/// tQueueSize is the ring size in bytes.
+template<typename tMessage, typename tAppInterface, size_t tQueueSize, size_t tMaxGroupSize = 16u>
+class QueueStdByteRing final {
+public:
+  using tMessage_ = tMessage;
+  using tAppInterface_ = tAppInterface;
+  using LogTime = typename tAppInterface::LogTime;
+
+  static constexpr size_t csQueueSize    = tQueueSize;
+  static constexpr bool   csWakeable     = true;
+  static constexpr bool   csGroupCommit  = true;
+  static constexpr size_t csShardCount   = 1u;
+  static constexpr size_t csMaxGroupSize = tMaxGroupSize;
+
+private:
+  using Wakeup = WakeupStd<LogTime>;
+  using Unit = uint64_t;
+
+  static constexpr size_t csCacheLineSize = 64u;
+
+  static constexpr size_t ceilPowerOfTwo(size_t const aValue) noexcept {
+    size_t result = 1u;
+    while(result < aValue) {
+      result <<= 1u;
+    }
+    return result;
+  }
+
+  static constexpr size_t csUnitSize  = sizeof(Unit);
+  static constexpr size_t csUnitCount = ceilPowerOfTwo((tQueueSize + csUnitSize - 1u) / csUnitSize);
+  static constexpr size_t csUnitMask  = csUnitCount - 1u;
+
+  // Record header unit: committed marker, task ID, flags, length in units including the header, item count.
+  static constexpr Unit     csCommitted   = 1u;
+  static constexpr uint32_t csShiftTaskId = 8u;
+  static constexpr uint32_t csShiftFlags  = 16u;
+  static constexpr uint32_t csShiftUnits  = 32u;
+  static constexpr uint32_t csShiftItems  = 48u;
+  static constexpr Unit     csFieldMask   = 0xffffu;
+  static constexpr Unit     csFlagSkip    = 1u;        // padding up to the end of the ring
+
+  // Item tags. A message item starts with its packed size, which is always smaller.
+  static constexpr uint8_t  csTagString        = 0xffu;
+  static constexpr size_t   csStringHeaderSize = 4u;   // tag, fill, 16-bit length
+
+  static constexpr size_t csMaxBodySize    = tMaxGroupSize * (1u + tMessage::csMaxPackedSize) + csStringHeaderSize;
+  static constexpr size_t csMaxRecordUnits = 1u + (csMaxBodySize + csUnitSize - 1u) / csUnitSize;
+
+  static_assert(tMaxGroupSize > 0u);
+  static_assert(tMessage::csMaxPackedSize < csTagString);
+  static_assert(csMaxRecordUnits <= csUnitCount);
+  static_assert(csUnitCount <= csFieldMask + 1u);  // the padding length must fit in its field
+
+  class FreeRtosQueue final {
+    alignas(csCacheLineSize) std::atomic<size_t>   mNextWrite;  // producers reserve units here
+    alignas(csCacheLineSize) std::atomic<size_t>   mNextRead;   // published by the consumer after a record was converted and cleared
+    alignas(csCacheLineSize) Wakeup                mWakeup;
+    alignas(csCacheLineSize) std::array<Unit, csUnitCount> mUnits;
+
+  public:
+    /// Consumed units are zeroed, so a non-zero header always belongs to the current round.
+    FreeRtosQueue() noexcept
+      : mNextWrite(0u)
+      , mNextRead(0u)
+      , mUnits{} {
+    }
+
+    ~FreeRtosQueue() noexcept = default;
+
+    bool empty() const noexcept {
+      return mNextRead.load(std::memory_order_relaxed) == mNextWrite.load(std::memory_order_relaxed);
+    }
+
+    bool pushGroup(tMessage const * const aMessages, size_t const aCount) noexcept {
+      size_t const bodySize = getBodySize(aMessages, aCount);
+      size_t const units = 1u + (bodySize + csUnitSize - 1u) / csUnitSize;
+      bool result = true;
+      size_t skip;
+      size_t position;
+      do {
+        // Read first, so the write position is not older and the difference can't wrap around.
+        size_t const read = mNextRead.load(std::memory_order_acquire);
+        position = mNextWrite.load(std::memory_order_relaxed);
+        size_t const offset = position & csUnitMask;
+        skip = (offset + units > csUnitCount) ? csUnitCount - offset : 0u;  // records never wrap
+        if(position + skip + units - read > csUnitCount) {
+          result = false;
+          break;
+        }
+        else { // nothing to do
+        }
+      } while(!mNextWrite.compare_exchange_weak(position, position + skip + units, std::memory_order_relaxed));
+      if(result) {
+        if(skip > 0u) {
+          publish(position, makeHeader(0u, csFlagSkip, skip, 0u));
+        }
+        else { // nothing to do
+        }
+        position += skip;
+        size_t const items = encode(reinterpret_cast<uint8_t*>(&mUnits[(position + 1u) & csUnitMask]), aMessages, aCount);
+        publish(position, makeHeader(aMessages[0].getTaskId(), 0u, units, items));
+        mWakeup.notify();
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
+
+    template<typename tVisitor>
+    size_t popGroup(tVisitor &&aVisitor, LogTime const aPauseLength) noexcept {
+      size_t result = 0u;
+      mWakeup.wait([this]{ return isNextCommitted(); }, aPauseLength);
+      size_t position = mNextRead.load(std::memory_order_relaxed);
+      Unit header = loadHeader(position);
+      if(header != 0u && (getField(header, csShiftFlags) & csFlagSkip) != 0u) {
+        position = release(position, getField(header, csShiftUnits));
+        header = loadHeader(position);
+      }
+      else { // nothing to do
+      }
+      if(header != 0u) {
+        do {
+          result = decode(reinterpret_cast<uint8_t const*>(&mUnits[(position + 1u) & csUnitMask]),
+                          static_cast<TaskId>(getField(header, csShiftTaskId)),
+                          getField(header, csShiftItems),
+                          aVisitor);
+        } while(!aVisitor.finish());
+        release(position, getField(header, csShiftUnits));
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
+
+    void wakeup() noexcept {
+      mWakeup.wakeup();
+    }
+
+  private:
+    static Unit makeHeader(TaskId const aTaskId, Unit const aFlags, size_t const aUnits, size_t const aItems) noexcept {
+      return csCommitted
+           | (static_cast<Unit>(aTaskId) << csShiftTaskId)
+           | (aFlags << csShiftFlags)
+           | (static_cast<Unit>(aUnits) << csShiftUnits)
+           | (static_cast<Unit>(aItems) << csShiftItems);
+    }
+
+    static size_t getField(Unit const aHeader, uint32_t const aShift) noexcept {
+      return static_cast<size_t>((aHeader >> aShift) & csFieldMask);
+    }
+
+    // Headers share the array with the raw payload bytes, so they are accessed atomically in place.
+    void publish(size_t const aPosition, Unit const aHeader) noexcept {
+#if defined(__cpp_lib_atomic_ref)
+      std::atomic_ref<Unit>(mUnits[aPosition & csUnitMask]).store(aHeader, std::memory_order_release);
+#else
+      __atomic_store_n(&mUnits[aPosition & csUnitMask], aHeader, __ATOMIC_RELEASE);
+#endif
+    }
+
+    Unit loadHeader(size_t const aPosition) noexcept {
+#if defined(__cpp_lib_atomic_ref)
+      return std::atomic_ref<Unit>(mUnits[aPosition & csUnitMask]).load(std::memory_order_acquire);
+#else
+      return __atomic_load_n(&mUnits[aPosition & csUnitMask], __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    // A later record may be published first, but the consumer must wait for the one at its read position.
+    bool isNextCommitted() noexcept {
+      return loadHeader(mNextRead.load(std::memory_order_relaxed)) != 0u;
+    }
+
+    // Producers reach the cleared units only after seeing the new read position.
+    size_t release(size_t const aPosition, size_t const aUnits) noexcept {
+      std::memset(&mUnits[aPosition & csUnitMask], 0, aUnits * csUnitSize);
+      size_t const result = aPosition + aUnits;
+      mNextRead.store(result, std::memory_order_release);
+      return result;
+    }
+
+    static bool isStringContinued(tMessage const &aMessage) noexcept {
+      return aMessage.isStoredChars() && LogFormat::isStringContinued(aMessage.getFill());
+    }
+
+    static size_t getBodySize(tMessage const * const aMessages, size_t const aCount) noexcept {
+      size_t result = 0u;
+      size_t i = 0u;
+      while(i < aCount) {
+        if(aMessages[i].isStoredChars()) {
+          result += csStringHeaderSize + 1u;
+          do {
+            result += std::strlen(aMessages[i].getStoredChars());
+            ++i;
+          } while(i < aCount && isStringContinued(aMessages[i - 1u]));
+        }
+        else {
+          result += 1u + aMessages[i].getPackedSize();
+          ++i;
+        }
+      }
+      return result;
+    }
+
+    /// @return the number of items written.
+    static size_t encode(uint8_t * const aDestination, tMessage const * const aMessages, size_t const aCount) noexcept {
+      size_t result = 0u;
+      uint8_t *where = aDestination;
+      size_t i = 0u;
+      while(i < aCount) {
+        if(aMessages[i].isStoredChars()) {
+          uint8_t * const header = where;
+          where += csStringHeaderSize;
+          do {
+            char const * const chars = aMessages[i].getStoredChars();
+            size_t const length = std::strlen(chars);
+            std::memcpy(where, chars, length);
+            where += length;
+            ++i;
+          } while(i < aCount && isStringContinued(aMessages[i - 1u]));
+          *where = 0u;
+          size_t const length = where - header - csStringHeaderSize;
+          ++where;
+          header[0] = csTagString;
+          header[1] = aMessages[i - 1u].getFill();
+          header[2] = static_cast<uint8_t>(length);
+          header[3] = static_cast<uint8_t>(length >> 8u);
+        }
+        else {
+          size_t const size = aMessages[i].pack(where + 1u);
+          *where = static_cast<uint8_t>(size);
+          where += 1u + size;
+          ++i;
+        }
+        ++result;
+      }
+      return result;
+    }
+
+    /// Calls aVisitor(tMessage const &) or aVisitor(char const *, uint8_t aFill) for each item.
+    template<typename tVisitor>
+    static size_t decode(uint8_t const * const aSource, TaskId const aTaskId, size_t const aItems, tVisitor &&aVisitor) noexcept {
+      uint8_t const *where = aSource;
+      tMessage message;
+      for(size_t i = 0u; i < aItems; ++i) {
+        if(*where == csTagString) {
+          size_t const length = where[2] | (static_cast<size_t>(where[3]) << 8u);
+          aVisitor(reinterpret_cast<char const*>(where + csStringHeaderSize), where[1]);
+          where += csStringHeaderSize + length + 1u;
+        }
+        else {
+          message.unpack(where + 1u, aTaskId, static_cast<MessageSequence>(i));
+          aVisitor(message);
+          where += 1u + *where;
+        }
+      }
+      return aItems;
+    }
+  };
+
+  inline static FreeRtosQueue sQueue;
+
+  QueueStdByteRing() = delete;
+
+public:
+  using Shard = FreeRtosQueue;   // For QueueSharded.
+
+  static void init() { // nothing to do
+  }
+
+  static void done() {  // nothing to do
+  }
+
+  static bool empty() noexcept {
+    return sQueue.empty();
+  }
+
+  static bool push(tMessage const &aMessage) noexcept {
+    return sQueue.pushGroup(&aMessage, 1u);
+  }
+
+  /// Either the whole group gets in or none of it.
+  static bool pushGroup(tMessage const * const aMessages, size_t const aCount) noexcept {
+    return sQueue.pushGroup(aMessages, aCount);
+  }
+
+  /// Calls aVisitor(tMessage const &) for each packed argument and
+  /// aVisitor(char const *, uint8_t aFill) for each joined string of the next group in order,
+  /// then aVisitor.finish(). The group is visited again while that returns false.
+  /// @return the number of items visited, 0 if no group arrived during aPauseLength.
+  template<typename tVisitor>
+  static size_t popGroup(tVisitor &&aVisitor, LogTime const aPauseLength) noexcept {
+    return sQueue.popGroup(std::forward<tVisitor>(aVisitor), aPauseLength);
+  }
+
+  static void wakeup() noexcept {
+    sQueue.wakeup();
+  }
+};
+
+}
+
+#endif
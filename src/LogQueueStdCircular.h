@@ -1,14 +1,20 @@
-#ifndef LOG_QUEUE_STD_BOOST
-#define LOG_QUEUE_STD_BOOST
+#ifndef LOG_QUEUE_STD_CIRCULAR
+#define LOG_QUEUE_STD_CIRCULAR
 
+#include "LogQueueOverflow.h"
+#include "LogWakeupStd.h"
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <mutex>
 #include <condition_variable>
 
 namespace nowtech::log {
 
-template<typename tMessage, typename tAppInterface, size_t tQueueSize>
+/// tOverflowPolicy is an OverflowPolicy instance, see LogQueueOverflow.h.
+template<typename tMessage, typename tAppInterface, size_t tQueueSize, typename tOverflowPolicy = OverflowPolicy<>>
 class QueueStdCircular final {
 public:
   using tMessage_ = tMessage;
@@ -16,18 +22,26 @@ public:
   using LogTime = typename tAppInterface::LogTime;
 
   static constexpr size_t csQueueSize = tQueueSize;
+  static constexpr bool   csWakeable  = true;
+  static constexpr bool   csGroupCommit = false;
+  static constexpr size_t csShardCount  = 1u;
 
 private:
+  using Wakeup = WakeupStd<LogTime>;
+
+  static constexpr OverflowAction csOverflowAction = tOverflowPolicy::csAction;
+
+  static_assert(tOverflowPolicy::csGroupHeadroom <= tQueueSize);
+
   class FreeRtosQueue final {
     std::array<tMessage, tQueueSize> mQueue;
     size_t                           mNextWrite;
     size_t                           mNextRead;
     std::atomic<size_t>              mOccupied;
-    std::atomic<bool>                mNotified;
     std::mutex                       mMutexPush;
-    std::mutex                       mMutexCv;
-    std::unique_lock<std::mutex>     mLockCv;
-    std::condition_variable          mConditionVariable;
+    Wakeup                           mWakeup;
+    std::atomic<size_t>              mBlockedCount;   // only for OverflowAction::cBlock
+    std::condition_variable          mConditionVariableRoom;
 
   public:
     /// First implementation, we assume we have plenty of memory.
@@ -35,8 +49,7 @@ private:
       : mNextWrite(0u)
       , mNextRead(0u)
       , mOccupied(0u)
-      , mLockCv(mMutexCv) {
-      mNotified = false;
+      , mBlockedCount(0u) {
     }
 
     ~FreeRtosQueue() noexcept = default;
@@ -45,35 +58,112 @@ private:
       return mOccupied == 0u;
     }
 
-    void push(tMessage const &aMessage) noexcept {
-      std::lock_guard<std::mutex> lock(mMutexPush);
-      if(mOccupied < tQueueSize) {
-        mQueue[mNextWrite] = aMessage;
-        mNextWrite = (mNextWrite + 1u) % tQueueSize;
-        ++mOccupied;        
-        mNotified = true;         // Having no lock_guard here makes tremendous speedup.
-        mConditionVariable.notify_one();
+    /// Either all the messages get in under one lock or none of them.
+    bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+      bool success = false;
+      {
+        std::unique_lock<std::mutex> lock(mMutexPush);
+        if constexpr(csOverflowAction == OverflowAction::cDropOldest) {
+          if(tQueueSize - mOccupied < aCount) {
+            evictOldest(aCount - (tQueueSize - mOccupied));
+          }
+          else { // nothing to do
+          }
+        }
+        else if constexpr(csOverflowAction == OverflowAction::cBlock) {
+          if(tQueueSize - mOccupied < aCount) {
+            ++mBlockedCount;
+            mConditionVariableRoom.wait_for(lock, std::chrono::milliseconds(tOverflowPolicy::csBlockTimeout), [this, aCount]{ return tQueueSize - mOccupied >= aCount; });
+            --mBlockedCount;
+          }
+          else { // nothing to do
+          }
+        }
+        else { // nothing to do
+        }
+        if(tQueueSize - mOccupied >= std::max<size_t>(aCount, tOverflowPolicy::requiredFree(aMessages[0]))) {
+          for(size_t i = 0u; i < aCount; ++i) {
+            mQueue[mNextWrite] = aMessages[i];
+            mNextWrite = (mNextWrite + 1u) % tQueueSize;
+          }
+          mOccupied += aCount;
+          success = true;
+        }
+        else { // nothing to do
+        }
+      }
+      if(success) {
+        mWakeup.notify();   // Syscall only if the consumer is parked.
       }
       else { // nothing to do
       }
+      return success;
     }
 
-    bool pop(tMessage &aMessage, LogTime const mPauseLength) noexcept {
-      bool result;
+    size_t popBatch(tMessage * const aMessages, size_t const aMaxCount, LogTime const aPauseLength) noexcept {
       // Safe to call empty because there will be only one consumer.
-      if(mOccupied == 0u &&
-        (!mConditionVariable.wait_for(mLockCv, std::chrono::milliseconds(mPauseLength), [this]{return mNotified == true;})
-        && !mNotified )) {  // This check makes the lock_guard on notifying unnecessary,
-        // because I don't care if I get in right during waiting or just at the beginning of next check.
-        result = false;
+      mWakeup.wait([this]{ return mOccupied != 0u; }, aPauseLength);
+      size_t result;
+      if constexpr(csOverflowAction == OverflowAction::cDropOldest) {
+        std::lock_guard<std::mutex> lock(mMutexPush);  // Producers may move mNextRead now.
+        result = copyOut(aMessages, aMaxCount);
       }
       else {
-        mNotified = false;
-        aMessage = mQueue[mNextRead];
+        result = copyOut(aMessages, aMaxCount);
+      }
+      if constexpr(csOverflowAction == OverflowAction::cBlock) {
+        // Both mOccupied and mBlockedCount are sequentially consistent, so a producer about to wait sees the room.
+        if(result > 0u && mBlockedCount > 0u) {
+          std::lock_guard<std::mutex> lock(mMutexPush);
+          mConditionVariableRoom.notify_all();
+        }
+        else { // nothing to do
+        }
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
+
+    void wakeup() noexcept {
+      mWakeup.wakeup();
+    }
+
+  private:
+    /// Drops at most aNeeded of the oldest evictable messages. The kept ones
+    /// among them are moved up in order to stay contiguous with the rest.
+    void evictOldest(size_t const aNeeded) noexcept {
+      size_t scanned = 0u;
+      size_t evicted = 0u;
+      while(evicted < aNeeded && scanned < mOccupied) {
+        if(tOverflowPolicy::isEvictable(mQueue[(mNextRead + scanned) % tQueueSize])) {
+          ++evicted;
+        }
+        else { // nothing to do
+        }
+        ++scanned;
+      }
+      size_t write = scanned;
+      for(size_t read = scanned; read > 0u; --read) {
+        tMessage const &message = mQueue[(mNextRead + read - 1u) % tQueueSize];
+        if(!tOverflowPolicy::isEvictable(message)) {
+          --write;
+          mQueue[(mNextRead + write) % tQueueSize] = message;
+        }
+        else { // nothing to do
+        }
+      }
+      mNextRead = (mNextRead + evicted) % tQueueSize;
+      mOccupied -= evicted;
+    }
+
+    size_t copyOut(tMessage * const aMessages, size_t const aMaxCount) noexcept {
+      size_t const result = std::min<size_t>(mOccupied, aMaxCount);
+      for(size_t i = 0u; i < result; ++i) {
+        aMessages[i] = mQueue[mNextRead];
         mNextRead = (mNextRead + 1u) % tQueueSize;
-        --mOccupied;
-        result = true;
       }
+      mOccupied -= result;  // One atomic operation for the whole batch.
       return result;
     }
   };
@@ -83,6 +173,8 @@ private:
   QueueStdCircular() = delete;
 
 public:
+  using Shard = FreeRtosQueue;   // For QueueSharded.
+
   static void init() { // nothing to do
   }
 
@@ -93,12 +185,24 @@ public:
     return sQueue.empty();
   }
 
-  static void push(tMessage const &aMessage) noexcept {
-    sQueue.push(aMessage);
+  static bool push(tMessage const &aMessage) noexcept {
+    return sQueue.pushBatch(&aMessage, 1u);
+  }
+
+  static bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+    return sQueue.pushBatch(aMessages, aCount);
   }
 
   static bool pop(tMessage &aMessage, LogTime const aPauseLength) noexcept {
-    return sQueue.pop(aMessage, aPauseLength);
+    return sQueue.popBatch(&aMessage, 1u, aPauseLength) > 0u;
+  }
+
+  static size_t popBatch(tMessage * const aMessages, size_t const aMaxCount, LogTime const aPauseLength) noexcept {
+    return sQueue.popBatch(aMessages, aMaxCount, aPauseLength);
+  }
+
+  static void wakeup() noexcept {
+    sQueue.wakeup();
   }
 };
 
@@ -0,0 +1,179 @@
+#ifndef LOG_QUEUE_STD_GROUP
+#define LOG_QUEUE_STD_GROUP
+
+#include "LogWakeupStd.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace nowtech::log {
+
+/// Multi-producer single-consumer queue transferring whole groups. Log stages
+/// a group in the shift chain helper, then reserves a run of consecutive
+/// slots with one compare-and-swap, copies the group and publishes it with a
+/// single stamp on its first slot. The transmitter converts the group right
+/// from the slots, so it needs no per-task reassembly lists.
+/// Groups longer than tMaxGroupSize are truncated, Log counts the rest as rejected.
+template<typename tMessage, typename tAppInterface, size_t tQueueSize, size_t tMaxGroupSize = 16u>
+class QueueStdGroup final {
+public:
+  using tMessage_ = tMessage;
+  using tAppInterface_ = tAppInterface;
+  using LogTime = typename tAppInterface::LogTime;
+
+  static constexpr size_t csQueueSize    = tQueueSize;
+  static constexpr bool   csWakeable     = true;
+  static constexpr bool   csGroupCommit  = true;
+  static constexpr size_t csShardCount   = 1u;
+  static constexpr size_t csMaxGroupSize = tMaxGroupSize;
+
+private:
+  using Wakeup = WakeupStd<LogTime>;
+
+  static constexpr size_t csCacheLineSize = 64u;
+
+  static constexpr size_t ceilPowerOfTwo(size_t const aValue) noexcept {
+    size_t result = 1u;
+    while(result < aValue) {
+      result <<= 1u;
+    }
+    return result;
+  }
+
+  // Positions may wrap around on 32-bit architectures, which is harmless for a power of two cell count.
+  static constexpr size_t csCellCount = ceilPowerOfTwo(tQueueSize);
+  static constexpr size_t csCellMask  = csCellCount - 1u;
+
+  static_assert(tMaxGroupSize > 0u);
+  static_assert(tMaxGroupSize <= tQueueSize);
+
+  struct Cell final {
+    std::atomic<size_t> mCommitted;  // position + 1 when this is the first cell of a published group
+    size_t              mCount;      // group length, valid only in the first cell
+    tMessage            mMessage;
+  };
+
+  class FreeRtosQueue final {
+    alignas(csCacheLineSize) std::atomic<size_t>   mNextWrite;  // producers reserve runs here
+    alignas(csCacheLineSize) std::atomic<size_t>   mNextRead;   // published by the consumer after a group was converted
+    alignas(csCacheLineSize) Wakeup                mWakeup;
+    alignas(csCacheLineSize) std::array<Cell, csCellCount> mCells;
+
+  public:
+    FreeRtosQueue() noexcept
+      : mNextWrite(0u)
+      , mNextRead(0u) {
+      for(auto &cell : mCells) {
+        cell.mCommitted.store(0u, std::memory_order_relaxed);
+      }
+    }
+
+    ~FreeRtosQueue() noexcept = default;
+
+    bool empty() const noexcept {
+      return mNextRead.load(std::memory_order_relaxed) == mNextWrite.load(std::memory_order_relaxed);
+    }
+
+    bool pushGroup(tMessage const * const aMessages, size_t const aCount) noexcept {
+      bool result = true;
+      size_t position;
+      do {
+        // Read first, so the write position is not older and the difference can't wrap around.
+        size_t const read = mNextRead.load(std::memory_order_acquire);
+        position = mNextWrite.load(std::memory_order_relaxed);
+        if(position + aCount - read > tQueueSize) {
+          result = false;
+          break;
+        }
+        else { // nothing to do
+        }
+      } while(!mNextWrite.compare_exchange_weak(position, position + aCount, std::memory_order_relaxed));
+      if(result) {
+        for(size_t i = 0u; i < aCount; ++i) {
+          mCells[(position + i) & csCellMask].mMessage = aMessages[i];
+        }
+        Cell &first = mCells[position & csCellMask];
+        first.mCount = aCount;
+        first.mCommitted.store(position + 1u, std::memory_order_release);
+        mWakeup.notify();
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
+
+    template<typename tVisitor>
+    size_t popGroup(tVisitor &&aVisitor, LogTime const aPauseLength) noexcept {
+      size_t result = 0u;
+      mWakeup.wait([this]{ return isNextCommitted(); }, aPauseLength);
+      size_t const position = mNextRead.load(std::memory_order_relaxed);
+      Cell &first = mCells[position & csCellMask];
+      if(first.mCommitted.load(std::memory_order_acquire) == position + 1u) {
+        result = first.mCount;
+        do {
+          for(size_t i = 0u; i < result; ++i) {
+            aVisitor(mCells[(position + i) & csCellMask].mMessage);
+          }
+        } while(!aVisitor.finish());
+        mNextRead.store(position + result, std::memory_order_release);
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
+
+    void wakeup() noexcept {
+      mWakeup.wakeup();
+    }
+
+  private:
+    // A later group may be published first, but the consumer must wait for the one at its read position.
+    bool isNextCommitted() const noexcept {
+      size_t const position = mNextRead.load(std::memory_order_relaxed);
+      return mCells[position & csCellMask].mCommitted.load(std::memory_order_acquire) == position + 1u;
+    }
+  };
+
+  inline static FreeRtosQueue sQueue;
+
+  QueueStdGroup() = delete;
+
+public:
+  using Shard = FreeRtosQueue;   // For QueueSharded.
+
+  static void init() { // nothing to do
+  }
+
+  static void done() {  // nothing to do
+  }
+
+  static bool empty() noexcept {
+    return sQueue.empty();
+  }
+
+  static bool push(tMessage const &aMessage) noexcept {
+    return sQueue.pushGroup(&aMessage, 1u);
+  }
+
+  /// Either the whole group gets in or none of it.
+  static bool pushGroup(tMessage const * const aMessages, size_t const aCount) noexcept {
+    return sQueue.pushGroup(aMessages, aCount);
+  }
+
+  /// Calls aVisitor(tMessage const &) for each message of the next group in order, then
+  /// aVisitor.finish(). The group is visited again while that returns false.
+  /// @return the length of the group, 0 if none arrived during aPauseLength.
+  template<typename tVisitor>
+  static size_t popGroup(tVisitor &&aVisitor, LogTime const aPauseLength) noexcept {
+    return sQueue.popGroup(std::forward<tVisitor>(aVisitor), aPauseLength);
+  }
+
+  static void wakeup() noexcept {
+    sQueue.wakeup();
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef LOG_QUEUE_STD_MPSC
+#define LOG_QUEUE_STD_MPSC
+
+#include "LogWakeupStd.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace nowtech::log {
+
+/// Bounded multi-producer single-consumer queue using a sequence-stamped
+/// array after Dmitry Vyukov. A push reserves its cells with one
+/// compare-and-swap on the write position, bounded by the read position, so
+/// it fails at once when the queue is full. A pop only loads the stamp of the
+/// next cell, because Log has exactly one consumer. Needs nothing beyond the
+/// standard library.
+template<typename tMessage, typename tAppInterface, size_t tQueueSize>
+class QueueStdMpsc final {
+public:
+  using tMessage_ = tMessage;
+  using tAppInterface_ = tAppInterface;
+  using LogTime = typename tAppInterface::LogTime;
+
+  static constexpr size_t csQueueSize = tQueueSize;
+  static constexpr bool   csWakeable  = true;
+  static constexpr bool   csGroupCommit = false;
+  static constexpr size_t csShardCount  = 1u;
+
+private:
+  using Wakeup = WakeupStd<LogTime>;
+
+  static constexpr size_t csCacheLineSize = 64u;
+
+  static constexpr size_t ceilPowerOfTwo(size_t const aValue) noexcept {
+    size_t result = 1u;
+    while(result < aValue) {
+      result <<= 1u;
+    }
+    return result;
+  }
+
+  // Positions may wrap around on 32-bit architectures, which is harmless for a power of two cell count.
+  static constexpr size_t csCellCount = ceilPowerOfTwo(tQueueSize);
+  static constexpr size_t csCellMask  = csCellCount - 1u;
+
+  static_assert(tQueueSize > 0u);
+
+  struct Cell final {
+    std::atomic<size_t> mSequence;
+    tMessage            mMessage;
+  };
+
+  class FreeRtosQueue final {
+    alignas(csCacheLineSize) std::atomic<size_t>   mNextWrite;  // producers claim cells here
+    alignas(csCacheLineSize) std::atomic<size_t>   mNextRead;   // published by the consumer for the fullness check
+    alignas(csCacheLineSize) Wakeup                mWakeup;
+    alignas(csCacheLineSize) std::array<Cell, csCellCount> mCells;
+
+  public:
+    FreeRtosQueue() noexcept
+      : mNextWrite(0u)
+      , mNextRead(0u) {
+      for(size_t i = 0u; i < csCellCount; ++i) {
+        mCells[i].mSequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    ~FreeRtosQueue() noexcept = default;
+
+    bool empty() const noexcept {
+      return mNextRead.load(std::memory_order_relaxed) == mNextWrite.load(std::memory_order_relaxed);
+    }
+
+    /// Claims consecutive cells for all the messages, or fails if they are not all free.
+    bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+      bool result = true;
+      size_t position;
+      do {
+        // Read first, so the write position is not older and the difference can't wrap around.
+        size_t const read = mNextRead.load(std::memory_order_acquire);
+        position = mNextWrite.load(std::memory_order_relaxed);
+        if(position + aCount - read > tQueueSize) {
+          result = false;
+          break;
+        }
+        else { // nothing to do
+        }
+      } while(!mNextWrite.compare_exchange_weak(position, position + aCount, std::memory_order_relaxed));
+      if(result) {
+        // The consumer freed these cells before publishing the read position seen above.
+        for(size_t i = 0u; i < aCount; ++i) {
+          Cell &cell = mCells[(position + i) & csCellMask];
+          cell.mMessage = aMessages[i];
+          cell.mSequence.store(position + i + 1u, std::memory_order_release);
+        }
+        mWakeup.notify();
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
+
+    size_t popBatch(tMessage * const aMessages, size_t const aMaxCount, LogTime const aPauseLength) noexcept {
+      mWakeup.wait([this]{ return isNextReady(); }, aPauseLength);
+      return tryPopBatch(aMessages, aMaxCount);
+    }
+
+    void wakeup() noexcept {
+      mWakeup.wakeup();
+    }
+
+  private:
+    // Only the consumer calls these, so the read position needs no atomic read-modify-write.
+    bool isNextReady() const noexcept {
+      size_t const position = mNextRead.load(std::memory_order_relaxed);
+      return mCells[position & csCellMask].mSequence.load(std::memory_order_acquire) == position + 1u;
+    }
+
+    size_t tryPopBatch(tMessage * const aMessages, size_t const aMaxCount) noexcept {
+      size_t result = 0u;
+      size_t position = mNextRead.load(std::memory_order_relaxed);
+      while(result < aMaxCount) {
+        Cell &cell = mCells[position & csCellMask];
+        if(cell.mSequence.load(std::memory_order_acquire) == position + 1u) {
+          aMessages[result] = cell.mMessage;
+          cell.mSequence.store(position + csCellCount, std::memory_order_release);
+          ++position;
+          ++result;
+        }
+        else {
+          break;
+        }
+      }
+      mNextRead.store(position, std::memory_order_release);  // Published once per batch, after freeing the cells.
+      return result;
+    }
+  };
+
+  inline static FreeRtosQueue sQueue;
+
+  QueueStdMpsc() = delete;
+
+public:
+  using Shard = FreeRtosQueue;   // For QueueSharded.
+
+  static void init() { // nothing to do
+  }
+
+  static void done() {  // nothing to do
+  }
+
+  static bool empty() noexcept {
+    return sQueue.empty();
+  }
+
+  static bool push(tMessage const &aMessage) noexcept {
+    return sQueue.pushBatch(&aMessage, 1u);
+  }
+
+  static bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+    return sQueue.pushBatch(aMessages, aCount);
+  }
+
+  static bool pop(tMessage &aMessage, LogTime const aPauseLength) noexcept {
+    return sQueue.popBatch(&aMessage, 1u, aPauseLength) > 0u;
+  }
+
+  static size_t popBatch(tMessage * const aMessages, size_t const aMaxCount, LogTime const aPauseLength) noexcept {
+    return sQueue.popBatch(aMessages, aMaxCount, aPauseLength);
+  }
+
+  static void wakeup() noexcept {
+    sQueue.wakeup();
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef LOG_QUEUE_STD_PER_TASK
+#define LOG_QUEUE_STD_PER_TASK
+
+#include "LogMessageBase.h"
+#include "LogWakeupStd.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace nowtech::log {
+
+/// Each TaskId gets its own single-producer single-consumer ring, so producers
+/// never touch a shared cache line when the consumer is busy. The contract is
+/// that only the task owning the TaskId pushes messages with that TaskId.
+/// tQueueSize is the capacity of each ring.
+template<typename tMessage, typename tAppInterface, size_t tQueueSize>
+class QueueStdPerTask final {
+public:
+  using tMessage_ = tMessage;
+  using tAppInterface_ = tAppInterface;
+  using LogTime = typename tAppInterface::LogTime;
+
+  static constexpr size_t csQueueSize = tQueueSize;
+  static constexpr bool   csWakeable  = true;
+  static constexpr bool   csGroupCommit = false;
+  static constexpr size_t csShardCount  = 1u;
+
+private:
+  using Wakeup = WakeupStd<LogTime>;
+
+  static constexpr size_t csCacheLineSize = 64u;
+  static constexpr size_t csRingCount     = tAppInterface::csMaxTaskCount + 1u;
+  static constexpr size_t csRingSize      = tQueueSize + 1u; // one slot is always left empty to tell full from empty
+
+  static_assert(tQueueSize > 0u);
+
+  class alignas(csCacheLineSize) Ring final {
+    alignas(csCacheLineSize) std::atomic<size_t> mNextWrite; // written only by the producer
+    size_t                                        mCachedNextRead;
+    alignas(csCacheLineSize) std::atomic<size_t> mNextRead;  // written only by the consumer
+    size_t                                        mCachedNextWrite;
+    alignas(csCacheLineSize) std::array<tMessage, csRingSize> mRing;
+
+  public:
+    Ring() noexcept
+      : mNextWrite(0u)
+      , mCachedNextRead(0u)
+      , mNextRead(0u)
+      , mCachedNextWrite(0u) {
+    }
+
+    bool empty() const noexcept {
+      return mNextRead.load(std::memory_order_relaxed) == mNextWrite.load(std::memory_order_acquire);
+    }
+
+    /// Publishes all the messages with one store.
+    bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+      bool result;
+      size_t const nextWrite = mNextWrite.load(std::memory_order_relaxed);
+      if(getFree(nextWrite) < aCount) {
+        mCachedNextRead = mNextRead.load(std::memory_order_acquire);
+      }
+      else { // nothing to do
+      }
+      if(getFree(nextWrite) >= aCount) {
+        for(size_t i = 0u; i < aCount; ++i) {
+          mRing[(nextWrite + i) % csRingSize] = aMessages[i];
+        }
+        mNextWrite.store((nextWrite + aCount) % csRingSize, std::memory_order_release);
+        result = true;
+      }
+      else {
+        result = false;
+      }
+      return result;
+    }
+
+    bool pop(tMessage &aMessage) noexcept {
+      bool result;
+      size_t const nextRead = mNextRead.load(std::memory_order_relaxed);
+      if(nextRead == mCachedNextWrite) {
+        mCachedNextWrite = mNextWrite.load(std::memory_order_acquire);
+      }
+      else { // nothing to do
+      }
+      if(nextRead != mCachedNextWrite) {
+        aMessage = mRing[nextRead];
+        mNextRead.store((nextRead + 1u) % csRingSize, std::memory_order_release);
+        result = true;
+      }
+      else {
+        result = false;
+      }
+      return result;
+    }
+
+  private:
+    size_t getFree(size_t const aNextWrite) const noexcept {
+      return (mCachedNextRead + csRingSize - aNextWrite - 1u) % csRingSize;
+    }
+  };
+
+  inline static std::array<Ring, csRingCount> sRings;
+  inline static size_t                        sNextRing = 0u;    // only the consumer touches it
+  inline static Wakeup                        sWakeup;
+
+  QueueStdPerTask() = delete;
+
+public:
+  static void init() { // nothing to do
+  }
+
+  static void done() {  // nothing to do
+  }
+
+  static bool empty() noexcept {
+    bool result = true;
+    for(auto const &ring : sRings) {
+      if(!ring.empty()) {
+        result = false;
+        break;
+      }
+      else { // nothing to do
+      }
+    }
+    return result;
+  }
+
+  static bool push(tMessage const &aMessage) noexcept {
+    return pushBatch(&aMessage, 1u);
+  }
+
+  /// All the messages must have the same TaskId.
+  static bool pushBatch(tMessage const * const aMessages, size_t const aCount) noexcept {
+    bool result;
+    TaskId const taskId = aMessages[0].getTaskId();
+    if(taskId < csRingCount && sRings[taskId].pushBatch(aMessages, aCount)) {
+      sWakeup.notify();
+      result = true;
+    }
+    else {
+      result = false;
+    }
+    return result;
+  }
+
+  static bool pop(tMessage &aMessage, LogTime const aPauseLength) noexcept {
+    return popBatch(&aMessage, 1u, aPauseLength) > 0u;
+  }
+
+  /// Visits the rings in round-robin order, so a chatty task can't starve the others.
+  static size_t popBatch(tMessage * const aMessages, size_t const aMaxCount, LogTime const aPauseLength) noexcept {
+    size_t result = popRoundRobin(aMessages, aMaxCount);
+    if(result == 0u) {
+      sWakeup.wait([]{ return !empty(); }, aPauseLength);
+      result = popRoundRobin(aMessages, aMaxCount);
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  static void wakeup() noexcept {
+    sWakeup.wakeup();
+  }
+
+private:
+  /// Drains each ring as far as the batch allows, the next call continues with the next ring.
+  static size_t popRoundRobin(tMessage * const aMessages, size_t const aMaxCount) noexcept {
+    size_t result = 0u;
+    for(size_t i = 0u; i < csRingCount && result < aMaxCount; ++i) {
+      auto &ring = sRings[sNextRing];
+      sNextRing = (sNextRing + 1u) % csRingCount;
+      while(result < aMaxCount && ring.pop(aMessages[result])) {
+        ++result;
+      }
+    }
+    return result;
+  }
+};
+
+}
+
+#endif
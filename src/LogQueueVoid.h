@@ -13,6 +13,9 @@ public:
   using LogTime = typename tAppInterface::LogTime;
 
   static constexpr size_t csQueueSize = 0u;
+  static constexpr bool   csWakeable  = false;
+  static constexpr bool   csGroupCommit = false;
+  static constexpr size_t csShardCount  = 1u;
 
 private:
   QueueVoid() = delete;
@@ -28,12 +31,24 @@ public:
     return true;
   }
 
-  static void push(tMessage const) noexcept { // nothing to do
+  static bool push(tMessage const) noexcept { // nothing to do
+    return false;
+  }
+
+  static bool pushBatch(tMessage const * const, size_t const) noexcept { // nothing to do
+    return false;
   }
 
   static bool pop(tMessage &, LogTime const) noexcept { // nothing to do
     return false;
   }
+
+  static size_t popBatch(tMessage * const, size_t const, LogTime const) noexcept { // nothing to do
+    return 0u;
+  }
+
+  static void wakeup() noexcept { // nothing to do
+  }
 };
 
 }
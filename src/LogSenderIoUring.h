@@ -0,0 +1,315 @@
+#ifndef NOWTECH_LOG_SENDER_IO_URING
+#define NOWTECH_LOG_SENDER_IO_URING
+
+#include "Log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace nowtech::log {
+
+/// Writes to a regular file through io_uring, so the transmitter does not wait
+/// for the write. The tBufferCount buffers of tTransmitBufferSize getBuffer()
+/// hands out are registered with the ring, and send() queues a fixed buffer write
+/// at the next file offset. Writes are submitted tBatchSize at a time with one
+/// io_uring_enter, or when Log finds its queue empty and calls flush(). Reaping
+/// completions returns the buffers, and the transmitter only waits when all of
+/// them are in flight. When the kernel has no io_uring, or the descriptor is not
+/// seekable, it falls back to plain write with one buffer. Only raw system calls
+/// are used, so there is no dependency on liburing. The descriptor remains owned
+/// by the application, done() waits for all writes and sets its offset after them.
+template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize, size_t tBufferCount = 8u, size_t tBatchSize = 4u>
+class SenderIoUring final {
+public:
+  using tAppInterface_   = tAppInterface;
+  using tConverter_      = tConverter;
+  using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator         = typename tConverter::Iterator;
+
+  static constexpr bool csVoid = false;
+
+private:
+  static_assert(tBufferCount >= 2u);
+  static_assert(tBatchSize >= 1u && tBatchSize < tBufferCount);
+
+  static constexpr int csInvalidFd = -1;
+
+  inline static int               sFd = csInvalidFd;
+  inline static int               sRingFd = csInvalidFd;      // csInvalidFd means plain write.
+  inline static off_t             sOffset;                    // Where the next write goes.
+  inline static ConversionResult *sBufferArea;                // All buffers in one block.
+  inline static uint32_t          sFree[tBufferCount];        // Stack of buffer indices.
+  inline static uint32_t          sFreeCount;
+  inline static uint32_t          sCurrent;                   // The buffer getBuffer hands out.
+  inline static uint32_t          sLengths[tBufferCount];     // For resuming short writes.
+  inline static off_t             sOffsets[tBufferCount];
+  inline static uint32_t          sUnsubmitted;
+
+  inline static void             *sRingMemory;
+  inline static size_t            sRingMemorySize;
+  inline static void             *sCqRingMemory;              // The same as sRingMemory with IORING_FEAT_SINGLE_MMAP.
+  inline static size_t            sCqRingMemorySize;
+  inline static io_uring_sqe     *sSqes;
+  inline static size_t            sSqesSize;
+  inline static uint32_t         *sSqTail;
+  inline static uint32_t          sSqMask;
+  inline static uint32_t         *sSqArray;
+  inline static uint32_t         *sCqHead;
+  inline static uint32_t         *sCqTail;
+  inline static uint32_t          sCqMask;
+  inline static io_uring_cqe     *sCqes;
+
+  SenderIoUring() = delete;
+
+public:
+  /// @param aTryIoUring false forces plain write.
+  static void init(int const aFd, bool const aTryIoUring = true) {
+    sFd = aFd;
+    sBufferArea = tAppInterface::template _newArray<ConversionResult>(tTransmitBufferSize * tBufferCount);
+    sCurrent = 0u;
+    for(uint32_t i = 1u; i < tBufferCount; ++i) {
+      sFree[i - 1u] = i;
+    }
+    sFreeCount = tBufferCount - 1u;
+    sUnsubmitted = 0u;
+    sOffset = ::lseek(aFd, 0, SEEK_CUR);
+    if(aTryIoUring && sOffset >= 0) {
+      setUpRing();
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void done() noexcept {
+    if(sRingFd != csInvalidFd) {
+      while(sFreeCount < tBufferCount - 1u) {
+        enter(sUnsubmitted, 1u, IORING_ENTER_GETEVENTS);
+        reap();
+      }
+      ::lseek(sFd, sOffset, SEEK_SET);
+      tearDownRing();
+    }
+    else { // nothing to do
+    }
+    tAppInterface::template _deleteArray<ConversionResult>(sBufferArea);
+  }
+
+  static bool isIoUring() noexcept {
+    return sRingFd != csInvalidFd;
+  }
+
+  /// The data is normally in the buffer of getBuffer() already, otherwise it is copied there.
+  static void send(char const * const aBegin, char const * const aEnd) {
+    ConversionResult * const buffer = getBuffer(sCurrent);
+    uint32_t const size = static_cast<uint32_t>(std::min<size_t>(aEnd - aBegin, tTransmitBufferSize));
+    if(aBegin != buffer) {
+      std::memmove(buffer, aBegin, size);
+    }
+    else { // nothing to do
+    }
+    if(sRingFd != csInvalidFd) {
+      queueWrite(sCurrent, size);
+      if(sUnsubmitted >= tBatchSize) {
+        enter(sUnsubmitted, 0u, 0u);
+      }
+      else { // nothing to do
+      }
+      reap();
+      while(sFreeCount == 0u) {
+        enter(sUnsubmitted, 1u, IORING_ENTER_GETEVENTS);
+        reap();
+      }
+      --sFreeCount;
+      sCurrent = sFree[sFreeCount];
+    }
+    else {
+      writeAll(buffer, size);
+    }
+  }
+
+  /// Submits the writes waiting for a full batch. Log calls it when its queue is empty.
+  static void flush() noexcept {
+    if(sRingFd != csInvalidFd && sUnsubmitted > 0u) {
+      enter(sUnsubmitted, 0u, 0u);
+      reap();
+    }
+    else { // nothing to do
+    }
+  }
+
+  static auto getBuffer() {
+    Iterator begin = getBuffer(sCurrent);
+    return std::pair(begin, begin + tTransmitBufferSize);
+  }
+
+private:
+  static ConversionResult* getBuffer(uint32_t const aIndex) noexcept {
+    return sBufferArea + aIndex * tTransmitBufferSize;
+  }
+
+  static void setUpRing() noexcept {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    sRingFd = static_cast<int>(::syscall(__NR_io_uring_setup, tBufferCount, &params));
+    if(sRingFd >= 0) {
+      mapAndRegister(params);
+    }
+    else {
+      sRingFd = csInvalidFd;
+    }
+  }
+
+  static void mapAndRegister(io_uring_params const &aParams) noexcept {
+    sRingMemorySize = aParams.sq_off.array + aParams.sq_entries * sizeof(uint32_t);
+    sCqRingMemorySize = aParams.cq_off.cqes + aParams.cq_entries * sizeof(io_uring_cqe);
+    bool const singleMmap = (aParams.features & IORING_FEAT_SINGLE_MMAP) != 0u;
+    if(singleMmap) {
+      sRingMemorySize = std::max(sRingMemorySize, sCqRingMemorySize);
+    }
+    else { // nothing to do
+    }
+    sSqesSize = aParams.sq_entries * sizeof(io_uring_sqe);
+    sRingMemory = ::mmap(nullptr, sRingMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, sRingFd, IORING_OFF_SQ_RING);
+    sCqRingMemory = singleMmap ? sRingMemory : ::mmap(nullptr, sCqRingMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, sRingFd, IORING_OFF_CQ_RING);
+    sSqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, sRingFd, IORING_OFF_SQES));
+    iovec buffers[tBufferCount];
+    for(uint32_t i = 0u; i < tBufferCount; ++i) {
+      buffers[i] = { getBuffer(i), tTransmitBufferSize };
+    }
+    if(sRingMemory != MAP_FAILED && sCqRingMemory != MAP_FAILED && sSqes != MAP_FAILED &&
+       ::syscall(__NR_io_uring_register, sRingFd, IORING_REGISTER_BUFFERS, buffers, tBufferCount) == 0) {
+      char * const sq = static_cast<char*>(sRingMemory);
+      sSqTail = reinterpret_cast<uint32_t*>(sq + aParams.sq_off.tail);
+      sSqMask = *reinterpret_cast<uint32_t*>(sq + aParams.sq_off.ring_mask);
+      sSqArray = reinterpret_cast<uint32_t*>(sq + aParams.sq_off.array);
+      char * const cq = static_cast<char*>(sCqRingMemory);
+      sCqHead = reinterpret_cast<uint32_t*>(cq + aParams.cq_off.head);
+      sCqTail = reinterpret_cast<uint32_t*>(cq + aParams.cq_off.tail);
+      sCqMask = *reinterpret_cast<uint32_t*>(cq + aParams.cq_off.ring_mask);
+      sCqes = reinterpret_cast<io_uring_cqe*>(cq + aParams.cq_off.cqes);
+    }
+    else {
+      tearDownRing();
+    }
+  }
+
+  static void tearDownRing() noexcept {
+    if(sSqes != MAP_FAILED) {
+      ::munmap(sSqes, sSqesSize);
+    }
+    else { // nothing to do
+    }
+    if(sCqRingMemory != MAP_FAILED && sCqRingMemory != sRingMemory) {
+      ::munmap(sCqRingMemory, sCqRingMemorySize);
+    }
+    else { // nothing to do
+    }
+    if(sRingMemory != MAP_FAILED) {
+      ::munmap(sRingMemory, sRingMemorySize);
+    }
+    else { // nothing to do
+    }
+    ::close(sRingFd);
+    sRingFd = csInvalidFd;
+  }
+
+  /// There are never more writes in flight than buffers, so the submission queue can not be full.
+  static void queueWrite(uint32_t const aIndex, uint32_t const aSize) noexcept {
+    uint32_t const position = __atomic_load_n(sSqTail, __ATOMIC_RELAXED);
+    io_uring_sqe &sqe = sSqes[position & sSqMask];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_WRITE_FIXED;
+    sqe.fd = sFd;
+    sqe.off = static_cast<uint64_t>(sOffset);
+    sqe.addr = reinterpret_cast<uint64_t>(getBuffer(aIndex));
+    sqe.len = aSize;
+    sqe.buf_index = static_cast<uint16_t>(aIndex);
+    sqe.user_data = aIndex;
+    sSqArray[position & sSqMask] = position & sSqMask;
+    __atomic_store_n(sSqTail, position + 1u, __ATOMIC_RELEASE);
+    sLengths[aIndex] = aSize;
+    sOffsets[aIndex] = sOffset;
+    sOffset += aSize;
+    ++sUnsubmitted;
+  }
+
+  static void enter(uint32_t const aToSubmit, uint32_t const aMinComplete, uint32_t const aFlags) noexcept {
+    long submitted;
+    do {
+      submitted = ::syscall(__NR_io_uring_enter, sRingFd, aToSubmit, aMinComplete, aFlags, nullptr, 0);
+    } while(submitted < 0 && errno == EINTR);
+    if(submitted >= 0) {
+      sUnsubmitted -= std::min<uint32_t>(sUnsubmitted, static_cast<uint32_t>(submitted));
+    }
+    else if(errno != EAGAIN && errno != EBUSY) {
+      tAppInterface::error(Exception::cSenderError);
+    }
+    else { // nothing to do, reaping makes room
+    }
+  }
+
+  /// Short writes are completed synchronously, they are rare with regular files.
+  static void reap() noexcept {
+    uint32_t position = __atomic_load_n(sCqHead, __ATOMIC_RELAXED);
+    uint32_t const end = __atomic_load_n(sCqTail, __ATOMIC_ACQUIRE);
+    while(position != end) {
+      io_uring_cqe const &cqe = sCqes[position & sCqMask];
+      uint32_t const index = static_cast<uint32_t>(cqe.user_data);
+      if(cqe.res < 0) {
+        tAppInterface::error(Exception::cSenderError);
+      }
+      else if(static_cast<uint32_t>(cqe.res) < sLengths[index]) {
+        pwriteAll(getBuffer(index) + cqe.res, sLengths[index] - cqe.res, sOffsets[index] + cqe.res);
+      }
+      else { // nothing to do
+      }
+      sFree[sFreeCount] = index;
+      ++sFreeCount;
+      ++position;
+    }
+    __atomic_store_n(sCqHead, position, __ATOMIC_RELEASE);
+  }
+
+  static void writeAll(char const *aBegin, size_t aSize) noexcept {
+    while(aSize > 0u) {
+      ssize_t const written = ::write(sFd, aBegin, aSize);
+      if(written >= 0) {
+        aBegin += written;
+        aSize -= static_cast<size_t>(written);
+      }
+      else if(errno != EINTR) {
+        tAppInterface::error(Exception::cSenderError);
+        aSize = 0u;
+      }
+      else { // nothing to do
+      }
+    }
+  }
+
+  static void pwriteAll(char const *aBegin, size_t aSize, off_t aOffset) noexcept {
+    while(aSize > 0u) {
+      ssize_t const written = ::pwrite(sFd, aBegin, aSize, aOffset);
+      if(written >= 0) {
+        aBegin += written;
+        aSize -= static_cast<size_t>(written);
+        aOffset += written;
+      }
+      else if(errno != EINTR) {
+        tAppInterface::error(Exception::cSenderError);
+        aSize = 0u;
+      }
+      else { // nothing to do
+      }
+    }
+  }
+};
+
+}
+
+#endif
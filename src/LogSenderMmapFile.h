@@ -0,0 +1,175 @@
+#ifndef NOWTECH_LOG_SENDER_MMAP_FILE
+#define NOWTECH_LOG_SENDER_MMAP_FILE
+
+#include "Log.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace nowtech::log {
+
+enum class MmapSync : uint8_t {
+  cNone,      // The kernel writes back the pages whenever it likes.
+  cAsync,     // msync with MS_ASYNC after each send.
+  cSegment    // msync with MS_SYNC when a segment is completed.
+};
+
+/// Lets the converter write right into the page cache of a memory-mapped file,
+/// so there is neither copy nor system call per send. getBuffer() hands out the
+/// next tTransmitBufferSize bytes of the current segment, which is a file of
+/// tSegmentSize named like the path given to init() followed by .0, .1 and so on.
+/// Numbering continues after the segments already present, so they are kept.
+/// Segments are allocated on disk before mapping, because writing to a hole of a
+/// full disk would raise SIGBUS. When less than tTransmitBufferSize remains, the
+/// segment is unmapped and truncated to its used length, and the next one is
+/// created. Should allocation or mapping fail, it reports Exception::cSenderError
+/// and discards output into a heap buffer.
+/// After a crash the active segment ends in zero bytes up to tSegmentSize.
+template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize, size_t tSegmentSize, MmapSync tSync = MmapSync::cNone, bool tAdviseSequential = true>
+class SenderMmapFile final {
+public:
+  using tAppInterface_   = tAppInterface;
+  using tConverter_      = tConverter;
+  using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator         = typename tConverter::Iterator;
+
+  static constexpr bool csVoid = false;
+
+private:
+  static_assert(tSegmentSize >= tTransmitBufferSize);
+
+  static constexpr int csInvalidFd = -1;
+
+  inline static std::string       sPath;
+  inline static uint32_t          sFirstSegmentIndex;
+  inline static uint32_t          sSegmentIndex;
+  inline static int               sFd = csInvalidFd;
+  inline static ConversionResult *sMapping = nullptr;
+  inline static size_t            sUsed;
+  inline static ConversionResult *sDiscardBuffer;    // Used when there is no mapping.
+  inline static uintptr_t         sPageMask;
+
+  SenderMmapFile() = delete;
+
+public:
+  static void init(char const * const aPath) {
+    sPath = aPath;
+    sSegmentIndex = 0u;
+    while(::access(getSegmentName(sSegmentIndex).c_str(), F_OK) == 0) {
+      ++sSegmentIndex;
+    }
+    sFirstSegmentIndex = sSegmentIndex;
+    sDiscardBuffer = tAppInterface::template _newArray<ConversionResult>(tTransmitBufferSize);
+    sPageMask = ~static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE) - 1);
+    openSegment();
+  }
+
+  static void done() noexcept {
+    closeSegment();
+    tAppInterface::template _deleteArray<ConversionResult>(sDiscardBuffer);
+  }
+
+  /// The data is normally in place already, as it was converted into the window of getBuffer().
+  static void send(char const * const aBegin, char const * const aEnd) {
+    if(sMapping != nullptr) {
+      size_t const size = std::min<size_t>(aEnd - aBegin, tTransmitBufferSize);
+      ConversionResult * const window = sMapping + sUsed;
+      if(aBegin != window) {
+        std::memmove(window, aBegin, size);
+      }
+      else { // nothing to do
+      }
+      sUsed += size;
+      if constexpr(tSync == MmapSync::cAsync) {
+        ConversionResult * const page = reinterpret_cast<ConversionResult*>(reinterpret_cast<uintptr_t>(window) & sPageMask);
+        ::msync(page, (window + size) - page, MS_ASYNC);
+      }
+      else { // nothing to do
+      }
+      if(tSegmentSize - sUsed < tTransmitBufferSize) {
+        closeSegment();
+        ++sSegmentIndex;
+        openSegment();
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  static auto getBuffer() {
+    Iterator begin = (sMapping != nullptr) ? sMapping + sUsed : sDiscardBuffer;
+    return std::pair(begin, begin + tTransmitBufferSize);
+  }
+
+  /// Index of the first segment written since init().
+  static uint32_t getFirstSegmentIndex() noexcept {
+    return sFirstSegmentIndex;
+  }
+
+private:
+  static std::string getSegmentName(uint32_t const aIndex) {
+    return sPath + '.' + std::to_string(aIndex);
+  }
+
+  static void openSegment() noexcept {
+    std::string const name = getSegmentName(sSegmentIndex);
+    sUsed = 0u;
+    sFd = ::open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    void *mapping = MAP_FAILED;
+    if(sFd != csInvalidFd && ::posix_fallocate(sFd, 0, static_cast<off_t>(tSegmentSize)) == 0) {
+      mapping = ::mmap(nullptr, tSegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, sFd, 0);
+    }
+    else { // nothing to do
+    }
+    if(mapping != MAP_FAILED) {
+      sMapping = static_cast<ConversionResult*>(mapping);
+      if constexpr(tAdviseSequential) {
+        ::madvise(mapping, tSegmentSize, MADV_SEQUENTIAL);
+      }
+      else { // nothing to do
+      }
+    }
+    else {
+      sMapping = nullptr;
+      if(sFd != csInvalidFd) {
+        ::close(sFd);
+        ::unlink(name.c_str());   // It would only be a hole, or in the way of the next init.
+        sFd = csInvalidFd;
+      }
+      else { // nothing to do
+      }
+      tAppInterface::error(Exception::cSenderError);
+    }
+  }
+
+  static void closeSegment() noexcept {
+    if(sMapping != nullptr) {
+      if constexpr(tSync == MmapSync::cSegment) {
+        ::msync(sMapping, tSegmentSize, MS_SYNC);
+      }
+      else { // nothing to do
+      }
+      ::munmap(sMapping, tSegmentSize);
+      sMapping = nullptr;
+      if(::ftruncate(sFd, static_cast<off_t>(sUsed)) != 0) {
+        tAppInterface::error(Exception::cSenderError);
+      }
+      else { // nothing to do
+      }
+      ::close(sFd);
+      sFd = csInvalidFd;
+    }
+    else { // nothing to do
+    }
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef NOWTECH_LOG_SENDER_POSIX_FD
+#define NOWTECH_LOG_SENDER_POSIX_FD
+
+#include "Log.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace nowtech::log {
+
+/// Writes to a raw file descriptor without the stream layers. Conversion goes
+/// into one of two buffers. When the descriptor is non-blocking, like a pipe
+/// opened with O_NONBLOCK, the part a slow reader does not accept yet stays in
+/// its buffer, and conversion continues in the other one. The next send writes
+/// the rest and the new data with one writev. The transmitter only waits when
+/// both buffers are taken. On a blocking descriptor each send completes the
+/// write, handling partial writes and EINTR. Data sent from elsewhere than
+/// getBuffer(), as direct sending does, has its rest copied to the free buffer.
+/// The descriptor remains owned by the application, done() only writes what is left.
+template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize>
+class SenderPosixFd final {
+public:
+  using tAppInterface_   = tAppInterface;
+  using tConverter_      = tConverter;
+  using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator         = typename tConverter::Iterator;
+
+  static constexpr bool csVoid = false;
+
+private:
+  static constexpr size_t csBufferCount = 2u;
+
+  inline static int                sFd = -1;
+  inline static ConversionResult  *sTransmitBuffers[csBufferCount];
+  inline static size_t             sCurrent;        // The buffer getBuffer hands out.
+  inline static char const        *sPendingBegin;   // Not yet written part of the other buffer.
+  inline static char const        *sPendingEnd;
+
+  SenderPosixFd() = delete;
+
+public:
+  static void init(int const aFd) {
+    sFd = aFd;
+    for(auto &buffer : sTransmitBuffers) {
+      buffer = tAppInterface::template _newArray<ConversionResult>(tTransmitBufferSize);
+    }
+    sCurrent = 0u;
+    sPendingBegin = nullptr;
+    sPendingEnd = nullptr;
+  }
+
+  static void done() noexcept {
+    writeAll(sPendingBegin, sPendingEnd);
+    sPendingBegin = sPendingEnd;
+    for(auto buffer : sTransmitBuffers) {
+      tAppInterface::template _deleteArray<ConversionResult>(buffer);
+    }
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd) {
+    char const *begin = aBegin;
+    bool tried = false;
+    if(sPendingBegin != sPendingEnd) {
+      iovec parts[csBufferCount] = {
+        { const_cast<char*>(sPendingBegin), static_cast<size_t>(sPendingEnd - sPendingBegin) },
+        { const_cast<char*>(aBegin), static_cast<size_t>(aEnd - aBegin) }
+      };
+      size_t const written = writeSome(parts, csBufferCount);
+      if(written >= parts[0].iov_len) {
+        begin += written - parts[0].iov_len;
+        tried = true;
+      }
+      else {   // The new data is in the other buffer, so this one must be free before it is handed out again.
+        writeAll(sPendingBegin + written, sPendingEnd);
+      }
+      sPendingBegin = sPendingEnd;
+    }
+    else { // nothing to do
+    }
+    if(!tried) {
+      iovec part = { const_cast<char*>(begin), static_cast<size_t>(aEnd - begin) };
+      begin += writeSome(&part, 1u);
+    }
+    else { // nothing to do
+    }
+    if(begin < aEnd) {
+      ConversionResult * const current = sTransmitBuffers[sCurrent];
+      if(isInBuffer(aBegin, current)) {
+        sPendingBegin = begin;
+        sPendingEnd = aEnd;
+        sCurrent = (sCurrent + 1u) % csBufferCount;
+      }
+      else if(static_cast<size_t>(aEnd - begin) <= tTransmitBufferSize) {   // Like the stack buffer of direct sending, which is gone after return.
+        std::memcpy(current, begin, aEnd - begin);
+        sPendingBegin = current;
+        sPendingEnd = current + (aEnd - begin);
+        sCurrent = (sCurrent + 1u) % csBufferCount;
+      }
+      else {
+        writeAll(begin, aEnd);
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  static auto getBuffer() {
+    Iterator begin = sTransmitBuffers[sCurrent];
+    return std::pair(begin, begin + tTransmitBufferSize);
+  }
+
+private:
+  static bool isInBuffer(char const * const aPointer, ConversionResult const * const aBuffer) noexcept {
+    auto const pointer = reinterpret_cast<uintptr_t>(aPointer);
+    auto const buffer = reinterpret_cast<uintptr_t>(aBuffer);
+    return pointer >= buffer && pointer < buffer + tTransmitBufferSize;
+  }
+
+  /// @return the bytes written, 0 if the descriptor would block. On error the data is dropped and counts as written.
+  static size_t writeSome(iovec * const aParts, size_t const aCount) noexcept {
+    size_t total = 0u;
+    for(size_t i = 0u; i < aCount; ++i) {
+      total += aParts[i].iov_len;
+    }
+    ssize_t written;
+    do {
+      written = ::writev(sFd, aParts, static_cast<int>(aCount));
+    } while(written < 0 && errno == EINTR);
+    size_t result;
+    if(written >= 0) {
+      result = static_cast<size_t>(written);
+    }
+    else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+      result = 0u;
+    }
+    else {
+      tAppInterface::error(Exception::cSenderError);
+      result = total;
+    }
+    return result;
+  }
+
+  static void writeAll(char const * const aBegin, char const * const aEnd) noexcept {
+    char const *begin = aBegin;
+    while(begin < aEnd) {
+      iovec part = { const_cast<char*>(begin), static_cast<size_t>(aEnd - begin) };
+      size_t const written = writeSome(&part, 1u);
+      begin += written;
+      if(written == 0u) {
+        pollfd waited = { sFd, POLLOUT, 0 };
+        ::poll(&waited, 1u, -1);
+      }
+      else { // nothing to do
+      }
+    }
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef NOWTECH_LOG_SENDER_SHARDED
+#define NOWTECH_LOG_SENDER_SHARDED
+
+#include "Log.h"
+#include <array>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace nowtech::log {
+
+/// Lets the transmitters of QueueSharded share one sender. Each shard converts
+/// into its own buffer of tTransmitBufferSize, and only the sending is
+/// serialized, so lines are never interleaved.
+template<typename tSender, size_t tShardCount, size_t tTransmitBufferSize>
+class SenderShared final {
+public:
+  using tAppInterface_   = typename tSender::tAppInterface_;
+  using tConverter_      = typename tSender::tConverter_;
+  using ConversionResult = typename tSender::ConversionResult;
+  using Iterator         = typename tSender::Iterator;
+
+  static constexpr bool   csVoid       = tSender::csVoid;
+  static constexpr size_t csShardCount = tShardCount;
+
+private:
+  inline static std::array<ConversionResult*, tShardCount> sTransmitBuffers;
+  inline static std::mutex                                 sMutex;
+
+  SenderShared() = delete;
+
+public:
+  /// Forwards the arguments to tSender::init.
+  template<typename ...tTypes>
+  static void init(tTypes... aArgs) {
+    tSender::init(aArgs...);
+    for(auto &buffer : sTransmitBuffers) {
+      buffer = tAppInterface_::template _newArray<ConversionResult>(tTransmitBufferSize);
+    }
+  }
+
+  static void done() noexcept {
+    for(auto buffer : sTransmitBuffers) {
+      tAppInterface_::template _deleteArray<ConversionResult>(buffer);
+    }
+    tSender::done();
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd, size_t const) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    tSender::send(aBegin, aEnd);
+  }
+
+  /// Exists if tSender has flush(), called when any shard finds its queue empty.
+  template <typename tDummy = void>
+  static auto flush(size_t const) -> std::enable_if_t<SenderFlushes<tSender>::value, tDummy> {
+    std::lock_guard<std::mutex> lock(sMutex);
+    tSender::flush();
+  }
+
+  static auto getBuffer(size_t const aShard) {
+    Iterator begin = sTransmitBuffers[aShard];
+    return std::pair(begin, begin + tTransmitBufferSize);
+  }
+};
+
+/// Gives each transmitter of QueueSharded its own sender, for example a
+/// separate file per shard. Shard i uses the i-th sender, which the
+/// application initializes. The senders must have distinct types, otherwise
+/// they would share their static state.
+template<typename tSender, typename ...tSenders>
+class SenderPerShard final {
+public:
+  using tAppInterface_   = typename tSender::tAppInterface_;
+  using tConverter_      = typename tSender::tConverter_;
+  using ConversionResult = typename tSender::ConversionResult;
+  using Iterator         = typename tSender::Iterator;
+
+  static constexpr bool   csVoid       = tSender::csVoid;
+  static constexpr size_t csShardCount = 1u + sizeof...(tSenders);
+
+private:
+  SenderPerShard() = delete;
+
+public:
+  static void done() noexcept {
+    tSender::done();
+    (tSenders::done(), ...);
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd, size_t const aShard) {
+    if(aShard == 0u) {
+      tSender::send(aBegin, aEnd);
+    }
+    else {
+      size_t shard = 1u;
+      (void)(... || (shard++ == aShard ? (tSenders::send(aBegin, aEnd), true) : false));
+    }
+  }
+
+  /// Exists if any of the senders has flush(), and flushes the one of the shard.
+  template <typename tDummy = void>
+  static auto flush(size_t const aShard) -> std::enable_if_t<(SenderFlushes<tSender>::value || ... || SenderFlushes<tSenders>::value), tDummy> {
+    if(aShard == 0u) {
+      flushIfSupported<tSender>();
+    }
+    else {
+      size_t shard = 1u;
+      (void)(... || (shard++ == aShard ? (flushIfSupported<tSenders>(), true) : false));
+    }
+  }
+
+  static auto getBuffer(size_t const aShard) {
+    auto result = tSender::getBuffer();
+    size_t shard = 1u;
+    (void)(... || (shard++ == aShard ? (result = tSenders::getBuffer(), true) : false));
+    return result;
+  }
+
+private:
+  template<typename tShardSender>
+  static void flushIfSupported() noexcept {
+    if constexpr(SenderFlushes<tShardSender>::value) {
+      tShardSender::flush();
+    }
+    else { // nothing to do
+    }
+  }
+};
+
+}
+
+#endif
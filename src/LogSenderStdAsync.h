@@ -0,0 +1,166 @@
+#ifndef NOWTECH_LOG_SENDER_STD_ASYNC
+#define NOWTECH_LOG_SENDER_STD_ASYNC
+
+#include "Log.h"
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace nowtech::log {
+
+/// Lets a separate I/O thread call tSender::send, so the transmitter converts
+/// the next groups while a slow sink blocks. Conversion goes into one of
+/// tBufferCount pooled buffers of tTransmitBufferSize. send() only queues the
+/// filled buffer for the I/O thread and takes a free one, which it waits for
+/// if all are queued. The I/O thread sends the buffers in order and returns
+/// them to the pool. The buffer of tSender is not used. If tSender has flush(),
+/// so has this one, and the I/O thread calls it after sending what is queued.
+template<typename tSender, size_t tBufferCount, size_t tTransmitBufferSize>
+class SenderStdAsync final {
+public:
+  using tAppInterface_   = typename tSender::tAppInterface_;
+  using tConverter_      = typename tSender::tConverter_;
+  using ConversionResult = typename tSender::ConversionResult;
+  using Iterator         = typename tSender::Iterator;
+
+  static constexpr bool csVoid = tSender::csVoid;
+
+private:
+  static_assert(tBufferCount >= 2u);
+
+  struct Filled final {
+    ConversionResult *mBegin;
+    ConversionResult *mEnd;
+  };
+
+  inline static std::array<ConversionResult*, tBufferCount> sBuffers;
+  inline static std::array<ConversionResult*, tBufferCount> sFree;     // Stack of buffers to convert into.
+  inline static size_t                                      sFreeCount;
+  inline static std::array<Filled, tBufferCount>            sFilled;   // Circular queue of buffers to send.
+  inline static size_t                                      sFilledHead;
+  inline static size_t                                      sFilledCount;
+  inline static ConversionResult                           *sCurrent;  // The buffer getBuffer hands out.
+  inline static bool                                        sKeepRunning;
+  inline static bool                                        sFlushRequested;
+  inline static std::mutex                                  sMutex;
+  inline static std::condition_variable                     sFilledCondition;
+  inline static std::condition_variable                     sFreeCondition;
+  inline static std::thread                                 sIoThread;
+
+  SenderStdAsync() = delete;
+
+public:
+  /// Forwards the arguments to tSender::init.
+  template<typename ...tTypes>
+  static void init(tTypes... aArgs) {
+    tSender::init(aArgs...);
+    for(auto &buffer : sBuffers) {
+      buffer = tAppInterface_::template _newArray<ConversionResult>(tTransmitBufferSize);
+    }
+    sCurrent = sBuffers[0];
+    std::copy(sBuffers.begin() + 1u, sBuffers.end(), sFree.begin());
+    sFreeCount = tBufferCount - 1u;
+    sFilledHead = 0u;
+    sFilledCount = 0u;
+    sKeepRunning = true;
+    sFlushRequested = false;
+    sIoThread = std::thread(ioThreadFunction);
+  }
+
+  /// Sends everything queued before stopping the I/O thread.
+  static void done() noexcept {
+    {
+      std::lock_guard<std::mutex> lock(sMutex);
+      sKeepRunning = false;
+    }
+    sFilledCondition.notify_one();
+    sIoThread.join();
+    for(auto buffer : sBuffers) {
+      tAppInterface_::template _deleteArray<ConversionResult>(buffer);
+    }
+    tSender::done();
+  }
+
+  /// The data is normally in the buffer of getBuffer() already, otherwise it is copied there.
+  static void send(char const * const aBegin, char const * const aEnd) {
+    size_t const size = std::min<size_t>(aEnd - aBegin, tTransmitBufferSize);
+    if(aBegin != sCurrent) {
+      std::memmove(sCurrent, aBegin, size);
+    }
+    else { // nothing to do
+    }
+    {
+      std::unique_lock<std::mutex> lock(sMutex);
+      sFilled[(sFilledHead + sFilledCount) % tBufferCount] = Filled{ sCurrent, sCurrent + size };
+      ++sFilledCount;
+      sFilledCondition.notify_one();
+      sFreeCondition.wait(lock, [](){ return sFreeCount > 0u; });
+      --sFreeCount;
+      sCurrent = sFree[sFreeCount];
+    }
+  }
+
+  /// Exists if tSender has flush(), which only the I/O thread may call.
+  template <typename tDummy = void>
+  static auto flush() -> std::enable_if_t<SenderFlushes<tSender>::value, tDummy> {
+    std::lock_guard<std::mutex> lock(sMutex);
+    if(!sFlushRequested) {
+      sFlushRequested = true;
+      sFilledCondition.notify_one();
+    }
+    else { // nothing to do
+    }
+  }
+
+  static auto getBuffer() {
+    Iterator begin = sCurrent;
+    return std::pair(begin, begin + tTransmitBufferSize);
+  }
+
+private:
+  /// Queued buffers go first, so a flush submits them too.
+  static void ioThreadFunction() noexcept {
+    std::unique_lock<std::mutex> lock(sMutex);
+    bool keepRunning = true;
+    while(keepRunning) {
+      sFilledCondition.wait(lock, [](){ return sFilledCount > 0u || sFlushRequested || !sKeepRunning; });
+      if(sFilledCount > 0u) {
+        Filled const filled = sFilled[sFilledHead];
+        lock.unlock();
+        tSender::send(filled.mBegin, filled.mEnd);
+        lock.lock();
+        sFilledHead = (sFilledHead + 1u) % tBufferCount;
+        --sFilledCount;
+        sFree[sFreeCount] = filled.mBegin;
+        ++sFreeCount;
+        sFreeCondition.notify_one();
+      }
+      else if(sFlushRequested) {
+        sFlushRequested = false;
+        lock.unlock();
+        flushSender();
+        lock.lock();
+      }
+      else {
+        keepRunning = false;
+      }
+    }
+  }
+
+  static void flushSender() noexcept {
+    if constexpr(SenderFlushes<tSender>::value) {
+      tSender::flush();
+    }
+    else { // nothing to do
+    }
+  }
+};
+
+}
+
+#endif
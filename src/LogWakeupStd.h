@@ -0,0 +1,99 @@
+#ifndef LOG_WAKEUP_STD
+#define LOG_WAKEUP_STD
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace nowtech::log {
+
+/// Spin-then-park wakeup for the single consumer of the STL queues. The
+/// consumer first polls its readiness condition for tSpinCount rounds, then
+/// advertises being parked and sleeps on the futex behind std::atomic::wait,
+/// or on a condition variable if it has a timeout or C++20 is not available. Producers pay only a
+/// fence and a relaxed load unless the consumer is actually parked.
+template<typename tLogTime, uint32_t tSpinCount = 64u>
+class WakeupStd final {
+public:
+  /// Pause length meaning the consumer sleeps until woken.
+  static constexpr tLogTime csWaitForever = std::numeric_limits<tLogTime>::max();
+
+private:
+  std::atomic<uint32_t>   mWoken;   // sticky, so a wakeup arriving before parking is not lost
+  std::atomic<bool>       mParked;
+  std::mutex              mMutex;
+  std::condition_variable mConditionVariable;
+
+public:
+  WakeupStd() noexcept
+    : mWoken(0u)
+    , mParked(false) {
+  }
+
+  /// Consumer side. Returns when aReady returns true, after wakeup() or
+  /// when aPauseLength ms elapsed. The caller re-checks its condition anyway.
+  template<typename tPredicate>
+  void wait(tPredicate aReady, tLogTime const aPauseLength) noexcept {
+    bool ready = aReady();
+    for(uint32_t i = 0u; !ready && i < tSpinCount; ++i) {
+      std::this_thread::yield();
+      ready = aReady();
+    }
+    if(!ready) {
+      mParked.store(true, std::memory_order_relaxed);
+      // Pairs with the fence in notify: either we see the new item or the producer sees us parked.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(!aReady()) {
+        if(aPauseLength == csWaitForever) {
+#if defined(__cpp_lib_atomic_wait)
+          mWoken.wait(0u, std::memory_order_acquire);
+#else
+          std::unique_lock<std::mutex> lock(mMutex);
+          mConditionVariable.wait(lock, [this]{ return mWoken.load(std::memory_order_acquire) != 0u; });
+#endif
+        }
+        else {
+          std::unique_lock<std::mutex> lock(mMutex);
+          mConditionVariable.wait_for(lock, std::chrono::milliseconds(aPauseLength), [this]{ return mWoken.load(std::memory_order_acquire) != 0u; });
+        }
+      }
+      else { // nothing to do
+      }
+      mParked.store(false, std::memory_order_relaxed);
+      mWoken.exchange(0u, std::memory_order_acquire);  // Acquire makes whatever preceded a consumed wakeup visible.
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Producer side, to be called after the item was published.
+  void notify() noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(mParked.load(std::memory_order_relaxed)) {
+      wakeup();
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Wakes the consumer regardless of its condition, for example to let it
+  /// notice shutdown. If it is not parked, its next wait returns at once.
+  void wakeup() noexcept {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mWoken.store(1u, std::memory_order_release);
+    }
+#if defined(__cpp_lib_atomic_wait)
+    mWoken.notify_one();
+#endif
+    mConditionVariable.notify_one();
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,400 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogMessageCompact.h"
+#include "LogConverterCustomText.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+// Integer conversion of ConverterCustomText against the former generic loop with a runtime base.
+// The outputs are compared first, so it doubles as a check of the kernels.
+// Floating point conversion in the fixed-digit and the shortest mode, the latter checked for reading back.
+// The integer-only float mode is checked against printf, which may round exact halfway cases differently.
+// The fixed notation of LC::F1 .. LC::F6 is checked against printf the same way.
+// double must not be narrowed to float in the integer-only mode.
+// Integers with a floating point format like LC::F2 or LC::Fs must be printed without fill.
+// Add -m32 to see the integer-only mode with 32-bit arithmetic like on a target without FPU.
+// clang++ -std=c++20 -O2 -Isrc test/benchmark-converter.cpp -o benchmark-converter
+
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgPayloadSize = 8u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgValueCount = 1u << 12u;
+constexpr size_t cgRoundCount = 1u << 10u;
+constexpr size_t cgBufferSize = 128u;
+constexpr size_t cgShortBufferSize = 7u;   // To check truncation.
+constexpr uint8_t cgFillFixed = 0u;                                            // LC::Fm
+constexpr int cgDoubleDigitCount = 16;                                         // Printed for double with LC::Fm.
+constexpr uint8_t cgFillShortest = nowtech::log::LogFormat::csFillValueShortest;  // LC::Fs
+constexpr uint8_t cgFillFixedPoint = nowtech::log::LogFormat::csFillValueFixed + 3u;  // LC::F3
+
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned, true>;
+using LogConverterIntegerFloat = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned, true, true>;
+
+/// The conversion before the kernels, kept here as the baseline.
+class LegacyConverter final {
+  char       *mBegin;
+  char * const mEnd;
+
+  inline static constexpr char csDigit2char[16] = {
+    '0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'
+  };
+
+public:
+  LegacyConverter(char * const aBegin, char * const aEnd) noexcept
+  : mBegin(aBegin)
+  , mEnd(aEnd) {
+  }
+
+  char* end() const noexcept {
+    return mBegin;
+  }
+
+  template<typename tValue>
+  void convert(tValue const aValue, uint8_t const aBase, uint8_t const aFill) noexcept {
+    using Wide = std::conditional_t<std::is_signed_v<tValue>, int64_t, uint64_t>;
+    append(static_cast<Wide>(aValue), static_cast<Wide>(aBase), aFill);
+    append(' ');
+  }
+
+private:
+  void append(char const aValue) noexcept {
+    if(mBegin < mEnd) {
+      *mBegin = aValue;
+      ++mBegin;
+    }
+    else { // nothing to do
+    }
+  }
+
+  template<typename tValue>
+  void append(tValue const aValue, tValue const aBase, uint8_t const aFill) noexcept {
+    tValue tmpValue = aValue;
+    uint8_t tmpFill = aFill;
+    if((aBase <= nowtech::log::NumericSystem::csInvalid) || (aBase > nowtech::log::NumericSystem::csBaseMax)) {
+      append('#');
+      return;
+    }
+    else { // nothing to do
+    }
+    if(cgAppendBasePrefix) {
+      if (aBase == 2u) {
+        append('0');
+        append('b');
+      }
+      else if(aBase == 16u) {
+        append('0');
+        append('x');
+      }
+      else if(aBase != 10u) {
+        append('0');
+        append('!');
+      }
+      else { // nothing to do
+      }
+    }
+    char tmpBuffer[cgAppendStackBufferSize];
+    uint8_t where = 0u;
+    bool negative = aValue < 0;
+    do {
+      tValue mod = tmpValue % aBase;
+      if(mod < 0) {
+        mod = -mod;
+      }
+      else { // nothing to do
+      }
+      tmpBuffer[where] = csDigit2char[mod];
+      ++where;
+      tmpValue /= aBase;
+    } while((tmpValue != 0) && (where < cgAppendStackBufferSize));
+    if(negative) {
+      append('-');
+    }
+    else if(cgAlignSigned && (aFill > 0u)) {
+      append(' ');
+    }
+    else { // nothing to do
+    }
+    if(tmpFill > where) {
+      tmpFill -= where;
+      while(tmpFill > 0u) {
+        append('0');
+        --tmpFill;
+      }
+    }
+    for(--where; where > 0u; --where) {
+      append(tmpBuffer[where]);
+    }
+    append(tmpBuffer[0]);
+  }
+};
+
+template<typename tConverter, typename tValue>
+size_t convertAll(std::vector<tValue> const &aValues, uint8_t const aBase, uint8_t const aFill, char * const aBuffer) {
+  size_t result = 0u;
+  for(auto value : aValues) {
+    tConverter converter(aBuffer, aBuffer + cgBufferSize);
+    converter.convert(value, aBase, aFill);
+    result += static_cast<size_t>(converter.end() - aBuffer);
+  }
+  return result;
+}
+
+template<typename tValue>
+bool check(std::vector<tValue> const &aValues, uint8_t const aBase, uint8_t const aFill, size_t const aBufferSize) {
+  bool result = true;
+  char expected[cgBufferSize];
+  char actual[cgBufferSize];
+  for(auto value : aValues) {
+    LegacyConverter legacy(expected, expected + aBufferSize);
+    legacy.convert(value, aBase, aFill);
+    LogConverterCustomText converter(actual, actual + aBufferSize);
+    converter.convert(value, aBase, aFill);
+    if(legacy.end() - expected != converter.end() - actual || std::memcmp(expected, actual, legacy.end() - expected) != 0) {
+      std::cout << "mismatch base " << static_cast<int>(aBase) << " fill " << static_cast<int>(aFill) << ": "
+                << std::string(expected, legacy.end()) << "vs " << std::string(actual, converter.end()) << '\n';
+      result = false;
+      break;
+    }
+    else { // nothing to do
+    }
+  }
+  return result;
+}
+
+/// Integers logged with a floating point format like LC::F2 or LC::Fs must be printed without fill.
+template<typename tValue>
+bool checkFloatFormat(std::vector<tValue> const &aValues, uint8_t const aBase, uint8_t const aFill) {
+  bool result = true;
+  char expected[cgBufferSize];
+  char actual[cgBufferSize];
+  for(auto value : aValues) {
+    LogConverterCustomText plain(expected, expected + cgBufferSize);
+    plain.convert(value, aBase, 0u);
+    LogConverterCustomText converter(actual, actual + cgBufferSize);
+    converter.convert(value, aBase, aFill);
+    if(plain.end() - expected != converter.end() - actual || std::memcmp(expected, actual, plain.end() - expected) != 0) {
+      std::cout << "mismatch float format base " << static_cast<int>(aBase) << " fill " << static_cast<int>(aFill) << ": "
+                << std::string(expected, plain.end()) << "vs " << std::string(actual, converter.end()) << '\n';
+      result = false;
+      break;
+    }
+    else { // nothing to do
+    }
+  }
+  return result;
+}
+
+template<typename tConverter, typename tValue>
+double measure(std::vector<tValue> const &aValues, uint8_t const aBase, uint8_t const aFill) {
+  char buffer[cgBufferSize];
+  size_t volatile sink = 0u;
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0u; i < cgRoundCount; ++i) {
+    sink = sink + convertAll<tConverter>(aValues, aBase, aFill, buffer);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / static_cast<double>(cgRoundCount * aValues.size());
+}
+
+template<typename tValue>
+std::vector<tValue> makeValues(uint32_t const aSeed) {
+  std::mt19937_64 generator(aSeed);
+  std::vector<tValue> result{0, 1, 9, 10, 99, 100, std::numeric_limits<tValue>::max(), std::numeric_limits<tValue>::min()};
+  while(result.size() < cgValueCount) {
+    uint64_t const random = generator();
+    result.push_back(static_cast<tValue>(random >> (random % 64u)));   // Spread the magnitudes.
+  }
+  return result;
+}
+
+template<typename tValue>
+bool measureAll(char const * const aName) {
+  bool result = true;
+  auto const values = makeValues<tValue>(sizeof(tValue));
+  for(uint8_t base = 2u; base <= 16u; ++base) {
+    result = check(values, base, 0u, cgBufferSize) && check(values, base, 20u, cgBufferSize) && check(values, base, 0u, cgShortBufferSize) && result;
+  }
+  for(uint8_t base : {10u, 16u}) {
+    result = checkFloatFormat(values, base, cgFillFixedPoint) && checkFloatFormat(values, base, cgFillShortest) && result;
+  }
+  std::cout << aName << '\n';
+  std::cout << "base  legacy ns  kernel ns\n";
+  for(uint8_t base : {2u, 7u, 8u, 10u, 16u}) {
+    std::cout << std::setw(4) << static_cast<int>(base) << std::setw(11) << std::fixed << std::setprecision(1)
+              << measure<LegacyConverter>(values, base, 0u) << std::setw(11) << measure<LogConverterCustomText>(values, base, 0u) << '\n';
+  }
+  return result;
+}
+
+template<typename tValue>
+bool checkShortest(std::vector<tValue> const &aValues) {
+  bool result = true;
+  char buffer[cgBufferSize];
+  for(auto value : aValues) {
+    LogConverterCustomText converter(buffer, buffer + cgBufferSize - 1u);
+    converter.convert(value, 10u, cgFillShortest);
+    *converter.end() = 0;
+    tValue const readBack = std::is_same_v<tValue, float> ? std::strtof(buffer, nullptr) : std::strtod(buffer, nullptr);
+    if(readBack != value) {
+      std::cout << "no round trip: " << std::setprecision(17) << value << " vs " << buffer << '\n';
+      result = false;
+      break;
+    }
+    else { // nothing to do
+    }
+  }
+  return result;
+}
+
+/// @return true if the last printed digit lies exactly halfway, where printf rounds to even.
+bool isHalfway(float const aValue, uint8_t const aDigitCount) {
+  char exact[cgBufferSize];
+  std::snprintf(exact, cgBufferSize, "%.60e", std::fabs(static_cast<double>(aValue)));
+  char const * const end = std::strchr(exact, 'e');
+  char const * const half = exact + aDigitCount + 1u;   // Skip the dot.
+  return *half == '5' && std::find_if(half + 1, end, [](char const aDigit){ return aDigit != '0'; }) == end;
+}
+
+bool checkInteger(std::vector<float> const &aValues, uint8_t const aDigitCount) {
+  bool result = true;
+  char buffer[cgBufferSize];
+  char expected[cgBufferSize];
+  for(auto value : aValues) {
+    LogConverterIntegerFloat converter(buffer, buffer + cgBufferSize - 1u);
+    converter.convert(value, 10u, aDigitCount);
+    *converter.end() = 0;
+    std::snprintf(expected, cgBufferSize, "%.*e", aDigitCount - 1, static_cast<double>(value));
+    if(std::strtod(buffer, nullptr) != std::strtod(expected, nullptr) && !isHalfway(value, aDigitCount)) {
+      std::cout << "integer mismatch: " << std::setprecision(17) << value << " vs " << buffer << '\n';
+      result = false;
+      break;
+    }
+    else { // nothing to do
+    }
+  }
+  return result;
+}
+
+/// @return true if the rest after the last printed decimal is about halfway, where printf
+/// rounds to even and the scaling in long double may tip over.
+bool isHalfwayFixed(double const aValue, uint8_t const aDecimals) {
+  char exact[cgBufferSize * 4u];
+  std::snprintf(exact, sizeof(exact), "%.160f", std::fabs(aValue));
+  char const * const half = std::strchr(exact, '.') + aDecimals + 1u;
+  return std::strncmp(half, "4999", 4u) == 0 || std::strncmp(half, "5000", 4u) == 0;
+}
+
+/// Values printed in scientific notation are left to the other checks.
+template<typename tConverter, typename tValue>
+bool checkFixed(std::vector<tValue> const &aValues, uint8_t const aDecimals) {
+  bool result = true;
+  char buffer[cgBufferSize];
+  char expected[cgBufferSize];
+  for(auto value : aValues) {
+    tConverter converter(buffer, buffer + cgBufferSize - 1u);
+    converter.convert(value, 10u, nowtech::log::LogFormat::csFillValueFixed + aDecimals);
+    *converter.end() = 0;
+    std::snprintf(expected, cgBufferSize, "%.*f ", aDecimals, static_cast<double>(value));
+    if(std::strchr(buffer, 'e') == nullptr && std::strcmp(buffer, expected) != 0 && !isHalfwayFixed(value, aDecimals)) {
+      std::cout << "fixed mismatch: " << std::setprecision(17) << value << " vs " << buffer << '\n';
+      result = false;
+      break;
+    }
+    else { // nothing to do
+    }
+  }
+  return result;
+}
+
+/// Values outside the float range must be printed within the last digit.
+template<typename tConverter, typename tValue>
+bool checkWide(tValue const aValue) {
+  char buffer[cgBufferSize];
+  tConverter converter(buffer, buffer + cgBufferSize - 1u);
+  converter.convert(aValue, 10u, 0u);
+  *converter.end() = 0;
+  double const error = std::fabs(std::strtod(buffer, nullptr) / static_cast<double>(aValue) - 1.0);
+  bool const result = error < std::pow(10.0, 1 - cgDoubleDigitCount);
+  if(!result) {
+    std::cout << "wide mismatch: " << std::setprecision(17) << aValue << " vs " << buffer << '\n';
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+template<typename tValue>
+bool measureFloat(char const * const aName) {
+  std::mt19937_64 generator(sizeof(tValue));
+  std::uniform_real_distribution<tValue> mantissa(-10.0, 10.0);
+  std::uniform_int_distribution<int> exponent(-30, 30);
+  std::vector<tValue> values;
+  while(values.size() < cgValueCount) {
+    values.push_back(static_cast<tValue>(mantissa(generator) * std::pow(10.0, exponent(generator))));
+  }
+  bool result = checkShortest(values);
+  for(uint8_t decimals = 0u; decimals <= nowtech::log::LogFormat::csMaxFixedDecimals; ++decimals) {
+    result = checkFixed<LogConverterCustomText>(values, decimals) && result;
+  }
+  if constexpr(std::is_same_v<tValue, float>) {
+    for(uint8_t digitCount = 1u; digitCount <= nowtech::log::IntegerFloat::csMaxDigitCount; ++digitCount) {
+      result = checkInteger(values, digitCount) && checkFixed<LogConverterIntegerFloat>(values, digitCount) && result;
+    }
+  }
+  else {   // Must not be narrowed to float.
+    for(uint8_t decimals = 0u; decimals <= nowtech::log::LogFormat::csMaxFixedDecimals; ++decimals) {
+      result = checkFixed<LogConverterIntegerFloat>(values, decimals) && result;
+    }
+    result = checkWide<LogConverterIntegerFloat>(static_cast<tValue>(1e300)) && checkWide<LogConverterIntegerFloat>(std::numeric_limits<tValue>::min()) && result;
+  }
+  std::cout << aName << " fixed ns  shortest ns  integer ns  F3 ns  F3 integer ns\n" << std::setw(static_cast<int>(std::strlen(aName)) + 9) << std::fixed << std::setprecision(1)
+            << measure<LogConverterCustomText>(values, 10u, cgFillFixed) << std::setw(13) << measure<LogConverterCustomText>(values, 10u, cgFillShortest)
+            << std::setw(12) << measure<LogConverterIntegerFloat>(values, 10u, cgFillFixed) << std::setw(7) << measure<LogConverterCustomText>(values, 10u, cgFillFixedPoint)
+            << std::setw(15) << measure<LogConverterIntegerFloat>(values, 10u, cgFillFixedPoint) << '\n';
+  return result;
+}
+
+int main() {
+  bool ok = measureAll<uint32_t>("uint32_t");
+  ok = measureAll<int32_t>("int32_t") && ok;
+  ok = measureAll<uint64_t>("uint64_t") && ok;
+  ok = measureAll<int64_t>("int64_t") && ok;
+  ok = measureFloat<float>("float") && ok;
+  ok = measureFloat<double>("double") && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogQueueStdBoost.h"
+#include "LogQueueStdCircular.h"
+#include "LogQueueStdMpsc.h"
+#include "LogQueueStdPerTask.h"
+#include "LogMessageCompact.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+// Producer scaling of the bare queues, without conversion and sending.
+// Producers retry a rejected push after yielding, so every message gets delivered
+// and the main figure is the wall time per delivered message until drained.
+// clang++ -std=c++20 -O2 -Isrc -Icpp-memory-manager test/benchmark-queues.cpp -lpthread -o benchmark-queues
+
+constexpr size_t cgMaxProducerCount = 64u;
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgMaxProducerCount + 1u;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr size_t cgPayloadSize = 8u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 4096u;
+constexpr size_t cgTotalPushCount = 1u << 22u;
+constexpr uint32_t cgPauseLength = 1u;
+constexpr size_t cgPopBatchSize = 8u;
+
+using LogAppInterface = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterface, cgQueueSize>;
+using LogQueueStdCircular = nowtech::log::QueueStdCircular<LogMessage, LogAppInterface, cgQueueSize>;
+using LogQueueStdMpsc = nowtech::log::QueueStdMpsc<LogMessage, LogAppInterface, cgQueueSize>;
+using LogQueueStdPerTask = nowtech::log::QueueStdPerTask<LogMessage, LogAppInterface, cgQueueSize>;
+
+struct Result final {
+  double nsPerDelivered;  // wall time until drained per message arriving at the consumer
+  double retryRatio;      // rejected push attempts per message
+  double deliveredRatio;  // should be 1
+};
+
+template<typename tQueue>
+Result measure(size_t const aProducerCount) {
+  std::atomic<bool> keepConsuming = true;
+  size_t delivered = 0u;
+  std::thread consumer([&keepConsuming, &delivered](){
+    LogMessage messages[cgPopBatchSize];
+    while(keepConsuming || !tQueue::empty()) {
+      delivered += tQueue::popBatch(messages, cgPopBatchSize, cgPauseLength);
+    }
+  });
+  size_t const pushPerProducer = cgTotalPushCount / aProducerCount;
+  std::atomic<size_t> retries = 0u;
+  std::vector<std::thread> producers;
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0u; i < aProducerCount; ++i) {
+    producers.emplace_back([i, pushPerProducer, &retries](){
+      LogMessage message;
+      auto const taskId = static_cast<nowtech::log::TaskId>(i + 1u);
+      size_t myRetries = 0u;
+      for(size_t j = 0u; j < pushPerProducer; ++j) {
+        message.set(static_cast<uint32_t>(j), LC::D5, taskId, static_cast<nowtech::log::MessageSequence>(j));
+        while(!tQueue::push(message)) {   // Full, let the consumer catch up.
+          ++myRetries;
+          std::this_thread::yield();
+        }
+      }
+      retries += myRetries;
+    });
+  }
+  for(auto &producer : producers) {
+    producer.join();
+  }
+  keepConsuming = false;
+  consumer.join();
+  auto endDrain = std::chrono::steady_clock::now();
+  double const pushCount = static_cast<double>(pushPerProducer * aProducerCount);
+  double const deliveredCount = static_cast<double>(delivered);
+  return Result{static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(endDrain - start).count()) / deliveredCount,
+                static_cast<double>(retries) / pushCount,
+                deliveredCount / pushCount};
+}
+
+template<typename tQueue>
+void measureAll(char const * const aName) {
+  tQueue::init();
+  std::cout << aName << '\n';
+  std::cout << "producers  ns/delivered  retries/push  delivered\n";
+  for(size_t producerCount = 1u; producerCount <= cgMaxProducerCount; producerCount *= 2u) {
+    auto result = measure<tQueue>(producerCount);
+    std::cout << std::setw(9) << producerCount << std::setw(14) << std::fixed << std::setprecision(1) << result.nsPerDelivered
+              << std::setw(14) << std::setprecision(3) << result.retryRatio << std::setw(11) << result.deliveredRatio << '\n';
+  }
+  tQueue::done();
+}
+
+int main() {
+  measureAll<LogQueueStdCircular>("QueueStdCircular");
+  measureAll<LogQueueStdBoost>("QueueStdBoost");
+  measureAll<LogQueueStdMpsc>("QueueStdMpsc");
+  measureAll<LogQueueStdPerTask>("QueueStdPerTask");
+  return 0;
+}
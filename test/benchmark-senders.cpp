@@ -0,0 +1,339 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogMessageCompact.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderStdOstream.h"
+#include "LogSenderPosixFd.h"
+#include "LogSenderMmapFile.h"
+#include "LogSenderIoUring.h"
+#include "LogSenderStdAsync.h"
+#include "LogSenderSharded.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+// Lines converted right into the sender buffer and sent one by one, to a file and to /dev/null.
+// Then the same with lines collected in a larger buffer, like Log does with tCoalesceHeadroom.
+// SenderPosixFd is also checked through a non-blocking pipe with a slow reader, which makes it keep partial writes.
+// SenderMmapFile is checked with small segments to see the content survive rotation. It has no /dev/null column.
+// SenderIoUring is checked against a file both with io_uring and with the plain write fallback.
+// SenderStdAsync, SenderShared and SenderPerShard are checked to forward flush() to a wrapped SenderIoUring.
+// clang++ -std=c++20 -O2 -Isrc -Icpp-memory-manager test/benchmark-senders.cpp -lpthread -o benchmark-senders
+// ./benchmark-senders /tmp/benchmark-senders.log
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = 1u;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgPayloadSize = 8u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgTransmitBufferSize = 256u;
+constexpr size_t cgCoalescedBufferSize = 1u << 16u;
+constexpr size_t cgCoalesceHeadroom = cgTransmitBufferSize;
+constexpr size_t cgLineCount = 1u << 20u;
+constexpr size_t cgPipeLineCount = 1u << 14u;
+constexpr size_t cgPipeReadSize = 1000u;
+constexpr size_t cgSegmentSize = 1u << 26u;
+constexpr size_t cgSmallSegmentSize = 4096u;
+constexpr size_t cgFlushBatchSize = 4u;
+constexpr uint32_t cgFlushLineCount = cgFlushBatchSize - 1u;   // Never submitted without flush().
+constexpr size_t cgFlushWaitCount = 1000u;
+
+using LogAppInterface = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterface::LogTime cgTimeout = 123u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
+using LogSenderPosixFd = nowtech::log::SenderPosixFd<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize>;
+using LogSenderStdOstreamCoalesced = nowtech::log::SenderStdOstream<LogAppInterface, LogConverterCustomText, cgCoalescedBufferSize, cgTimeout>;
+using LogSenderPosixFdCoalesced = nowtech::log::SenderPosixFd<LogAppInterface, LogConverterCustomText, cgCoalescedBufferSize>;
+using LogSenderMmapFile = nowtech::log::SenderMmapFile<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, cgSegmentSize>;
+using LogSenderMmapFileCoalesced = nowtech::log::SenderMmapFile<LogAppInterface, LogConverterCustomText, cgCoalescedBufferSize, cgSegmentSize>;
+using LogSenderIoUring = nowtech::log::SenderIoUring<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize>;
+using LogSenderIoUringCoalesced = nowtech::log::SenderIoUring<LogAppInterface, LogConverterCustomText, cgCoalescedBufferSize>;
+using LogSenderMmapFileSmall = nowtech::log::SenderMmapFile<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, cgSmallSegmentSize>;
+// The buffer counts differ only to give each wrapped sender its own static state.
+using LogSenderIoUringAsync = nowtech::log::SenderIoUring<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, 8u, cgFlushBatchSize>;
+using LogSenderIoUringShared = nowtech::log::SenderIoUring<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, 9u, cgFlushBatchSize>;
+using LogSenderIoUringPerShard = nowtech::log::SenderIoUring<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, 10u, cgFlushBatchSize>;
+using LogSenderAsync = nowtech::log::SenderStdAsync<LogSenderIoUringAsync, 2u, cgTransmitBufferSize>;
+using LogSenderShared = nowtech::log::SenderShared<LogSenderIoUringShared, 2u, cgTransmitBufferSize>;
+using LogSenderPerShard = nowtech::log::SenderPerShard<LogSenderPosixFd, LogSenderIoUringPerShard>;   // Only shard 1 flushes.
+
+/// @return the end of the line.
+char* convertLine(char * const aBegin, char * const aEnd, uint32_t const aIndex) {
+  LogConverterCustomText converter(aBegin, aEnd);
+  converter.convert("thread_0", 10u, 0u);
+  converter.convert(aIndex, 10u, 0u);
+  converter.convert("a message of moderate length with a value:", 10u, 0u);
+  converter.convert(aIndex * 2654435761u, 16u, 8u);
+  converter.terminateSequence();
+  return converter.end();
+}
+
+template<typename tSender>
+void sendLine(uint32_t const aIndex) {
+  auto [begin, end] = tSender::getBuffer();
+  tSender::send(begin, convertLine(begin, end, aIndex));
+}
+
+/// @return ns per line
+template<typename tSender>
+double measure() {
+  auto start = std::chrono::steady_clock::now();
+  for(uint32_t i = 0u; i < cgLineCount; ++i) {
+    sendLine<tSender>(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / cgLineCount;
+}
+
+/// @return ns per line
+template<typename tSender>
+double measureCoalesced() {
+  auto start = std::chrono::steady_clock::now();
+  uint32_t i = 0u;
+  while(i < cgLineCount) {
+    auto [begin, end] = tSender::getBuffer();
+    char *lineEnd = begin;
+    while(i < cgLineCount && static_cast<size_t>(end - lineEnd) >= cgCoalesceHeadroom) {
+      lineEnd = convertLine(lineEnd, end, i);
+      ++i;
+    }
+    tSender::send(begin, lineEnd);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / cgLineCount;
+}
+
+template<typename tSender, bool tCoalesced>
+double measureStdOstream(char const * const aPath) {
+  std::ofstream stream(aPath, std::ios::binary | std::ios::trunc);
+  tSender::init(&stream);
+  double const result = tCoalesced ? measureCoalesced<tSender>() : measure<tSender>();
+  tSender::done();
+  stream.flush();
+  return result;
+}
+
+template<typename tSender, bool tCoalesced>
+double measurePosixFd(char const * const aPath) {
+  int const fd = ::open(aPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  tSender::init(fd);
+  double const result = tCoalesced ? measureCoalesced<tSender>() : measure<tSender>();
+  tSender::done();
+  ::close(fd);
+  return result;
+}
+
+template<typename tSender, bool tCoalesced>
+double measureIoUring(char const * const aPath) {
+  int const fd = ::open(aPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  tSender::init(fd);
+  double const result = tCoalesced ? measureCoalesced<tSender>() : measure<tSender>();
+  tSender::done();
+  ::close(fd);
+  return result;
+}
+
+/// @return true if the file contains exactly the lines sent.
+bool checkIoUring(char const * const aPath, bool const aTryIoUring) {
+  int const fd = ::open(aPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  std::string expected;
+  char line[cgTransmitBufferSize];
+  LogSenderIoUring::init(fd, aTryIoUring);
+  std::cout << "io_uring " << (LogSenderIoUring::isIoUring() ? "in use" : "not in use") << ": ";
+  for(uint32_t i = 0u; i < cgPipeLineCount; ++i) {
+    sendLine<LogSenderIoUring>(i);                              // The buffer may be reused afterwards.
+    expected.append(line, convertLine(line, line + cgTransmitBufferSize, i));
+  }
+  LogSenderIoUring::done();
+  ::close(fd);
+  std::ifstream file(aPath, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()) == expected;
+}
+
+/// @return the file content once it has reached aLength, or after about a second.
+std::string waitForFile(char const * const aPath, size_t const aLength) {
+  std::string result;
+  for(size_t i = 0u; i < cgFlushWaitCount && result.size() < aLength; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::ifstream file(aPath, std::ios::binary);
+    result.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  return result;
+}
+
+/// Sends fewer lines than a batch through the wrapper and flushes it, then expects them in the file before done().
+template<typename tSender, typename tIoUring>
+bool checkFlush(char const * const aPath, char const * const aName, size_t const aShard) {
+  int const fd = ::open(aPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  std::string expected;
+  char line[cgTransmitBufferSize];
+  if constexpr(std::is_same_v<tSender, LogSenderPerShard>) {
+    LogSenderPosixFd::init(fd);
+    tIoUring::init(fd);
+  }
+  else {
+    tSender::init(fd);
+  }
+  for(uint32_t i = 0u; i < cgFlushLineCount; ++i) {
+    if constexpr(std::is_same_v<tSender, LogSenderAsync>) {
+      sendLine<tSender>(i);
+    }
+    else {
+      auto [begin, end] = tSender::getBuffer(aShard);
+      tSender::send(begin, convertLine(begin, end, i), aShard);
+    }
+    expected.append(line, convertLine(line, line + cgTransmitBufferSize, i));
+  }
+  if constexpr(std::is_same_v<tSender, LogSenderAsync>) {
+    tSender::flush();
+  }
+  else {
+    tSender::flush(aShard);
+  }
+  bool const result = waitForFile(aPath, expected.size()) == expected;
+  tSender::done();
+  ::close(fd);
+  std::cout << aName << " flush: " << (result ? "ok" : "MISMATCH") << '\n';
+  return result;
+}
+
+/// Reads and removes the segments written by SenderMmapFile.
+template<typename tSender>
+std::string collectSegments(char const * const aPath) {
+  std::string result;
+  for(uint32_t index = tSender::getFirstSegmentIndex(); ; ++index) {
+    std::string const name = std::string(aPath) + '.' + std::to_string(index);
+    std::ifstream segment(name, std::ios::binary);
+    if(!segment) {
+      break;
+    }
+    result.append(std::istreambuf_iterator<char>(segment), std::istreambuf_iterator<char>());
+    std::remove(name.c_str());
+  }
+  return result;
+}
+
+template<typename tSender, bool tCoalesced>
+double measureMmapFile(char const * const aPath) {
+  tSender::init(aPath);
+  double const result = tCoalesced ? measureCoalesced<tSender>() : measure<tSender>();
+  tSender::done();
+  collectSegments<tSender>(aPath);
+  return result;
+}
+
+/// Segments hold only some lines each, so they are rotated and truncated many times.
+bool checkMmapRotation(char const * const aPath) {
+  std::string expected;
+  LogSenderMmapFileSmall::init(aPath);
+  char line[cgTransmitBufferSize];
+  for(uint32_t i = 0u; i < cgPipeLineCount; ++i) {
+    sendLine<LogSenderMmapFileSmall>(i);                        // The segment may be unmapped afterwards.
+    expected.append(line, convertLine(line, line + cgTransmitBufferSize, i));
+  }
+  LogSenderMmapFileSmall::done();
+  return collectSegments<LogSenderMmapFileSmall>(aPath) == expected;
+}
+
+/// The reader is slower than the writer, so the pipe gets full and the writes partial.
+/// The buffer of the lines sent from outside is overwritten after each send.
+bool checkNonBlockingPipe() {
+  int fds[2];
+  if(::pipe(fds) != 0) {
+    return false;
+  }
+  ::fcntl(fds[1], F_SETFL, ::fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+  std::string received;
+  std::thread reader([&received, fd = fds[0]](){
+    char buffer[cgPipeReadSize];
+    ssize_t count;
+    while((count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+      received.append(buffer, static_cast<size_t>(count));
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+  });
+  std::string expected;
+  LogSenderPosixFd::init(fds[1]);
+  for(uint32_t i = 0u; i < cgPipeLineCount; ++i) {
+    char line[cgTransmitBufferSize];                            // Every second line comes from outside, like with direct sending.
+    char * const lineEnd = convertLine(line, line + cgTransmitBufferSize, i);
+    expected.append(line, lineEnd);
+    if(i % 2u == 0u) {
+      sendLine<LogSenderPosixFd>(i);
+    }
+    else {
+      LogSenderPosixFd::send(line, lineEnd);
+      std::fill(line, lineEnd, '#');
+    }
+  }
+  LogSenderPosixFd::done();
+  ::close(fds[1]);
+  reader.join();
+  ::close(fds[0]);
+  return received == expected;
+}
+
+int main(int argc, char **argv) {
+  char const * const path = argc > 1 ? argv[1] : "benchmark-senders.log";
+  bool const okPipe = checkNonBlockingPipe();
+  std::cout << "non-blocking pipe: " << (okPipe ? "ok" : "MISMATCH") << '\n';
+  bool const okRotation = checkMmapRotation(path);
+  std::cout << "mmap rotation: " << (okRotation ? "ok" : "MISMATCH") << '\n';
+  bool okIoUring = true;
+  for(bool const tryIoUring : { true, false }) {
+    bool const ok = checkIoUring(path, tryIoUring);
+    std::cout << (ok ? "ok" : "MISMATCH") << '\n';
+    okIoUring = okIoUring && ok;
+  }
+  bool okFlush = checkFlush<LogSenderAsync, LogSenderIoUringAsync>(path, "SenderStdAsync", 0u);
+  okFlush = checkFlush<LogSenderShared, LogSenderIoUringShared>(path, "SenderShared", 1u) && okFlush;
+  okFlush = checkFlush<LogSenderPerShard, LogSenderIoUringPerShard>(path, "SenderPerShard", 1u) && okFlush;
+  std::cout << std::setw(20) << "ns per line" << std::setw(12) << "file" << std::setw(12) << "/dev/null" << std::setw(16) << "coalesced file" << std::setw(16) << "coal. /dev/null" << '\n';
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::setw(20) << "SenderStdOstream" << std::setw(12) << measureStdOstream<LogSenderStdOstream, false>(path) << std::setw(12) << measureStdOstream<LogSenderStdOstream, false>("/dev/null")
+            << std::setw(16) << measureStdOstream<LogSenderStdOstreamCoalesced, true>(path) << std::setw(16) << measureStdOstream<LogSenderStdOstreamCoalesced, true>("/dev/null") << '\n';
+  std::cout << std::setw(20) << "SenderPosixFd" << std::setw(12) << measurePosixFd<LogSenderPosixFd, false>(path) << std::setw(12) << measurePosixFd<LogSenderPosixFd, false>("/dev/null")
+            << std::setw(16) << measurePosixFd<LogSenderPosixFdCoalesced, true>(path) << std::setw(16) << measurePosixFd<LogSenderPosixFdCoalesced, true>("/dev/null") << '\n';
+  std::cout << std::setw(20) << "SenderMmapFile" << std::setw(12) << measureMmapFile<LogSenderMmapFile, false>(path) << std::setw(12) << "-"
+            << std::setw(16) << measureMmapFile<LogSenderMmapFileCoalesced, true>(path) << std::setw(16) << "-" << '\n';
+  std::cout << std::setw(20) << "SenderIoUring" << std::setw(12) << measureIoUring<LogSenderIoUring, false>(path) << std::setw(12) << measureIoUring<LogSenderIoUring, false>("/dev/null")
+            << std::setw(16) << measureIoUring<LogSenderIoUringCoalesced, true>(path) << std::setw(16) << measureIoUring<LogSenderIoUringCoalesced, true>("/dev/null") << '\n';
+  std::remove(path);
+  return okPipe && okRotation && okIoUring && okFlush ? 0 : 1;
+}
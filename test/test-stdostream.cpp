@@ -61,6 +61,7 @@ constexpr bool cgArchitecture64 = true;
 constexpr uint8_t cgAppendStackBufferSize = 100u;
 constexpr bool cgAppendBasePrefix = true;
 constexpr bool cgAlignSigned = false;
+constexpr bool cgShortestFloat = true;
 using AtomicBufferType = int32_t;
 constexpr size_t cgAtomicBufferExponent = 14u;
 constexpr AtomicBufferType cgAtomicBufferInvalidValue = 1234546789;
@@ -77,7 +78,7 @@ using LogAppInterface = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromI
 constexpr typename LogAppInterface::LogTime cgTimeout = 123u;
 constexpr typename LogAppInterface::LogTime cgRefreshPeriod = 444;
 using LogMessage = nowtech::log::MessageVariant<cgPayloadSize, cgSupportFloatingPoint>;
-using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned, cgShortestFloat>;
 using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
 using LogQueueVoid = nowtech::log::QueueVoid<LogMessage, LogAppInterface>;
 using LogAtomicBuffer = nowtech::log::AtomicBufferOperational<LogAppInterface, AtomicBufferType, cgAtomicBufferExponent, cgAtomicBufferInvalidValue>;
@@ -152,6 +153,10 @@ int main() {
   Log::i() << "double: " << -1.234567890 << Log::end;
   Log::i() << "float: " << LC::Fm << -123.4567890f << Log::end;
   Log::i() << "double: " << LC::Fm << 123.4567890 << Log::end;
+  Log::i() << "float: " << LC::Fs << -123.4567890f << Log::end;
+  Log::i() << "double: " << LC::Fs << 0.1 << Log::end;
+  Log::i() << "float: " << LC::F2 << 12.345f << LC::F3 << -0.0005f << LC::F6 << 1e30f << Log::end;
+  Log::i() << "double: " << LC::F3 << 12.345 << LC::F1 << -99.96 << LC::F6 << 1e-9 << Log::end;
   Log::i() << "long double: " << -0.01234567890L << Log::end;
   Log::i() << "long double: " << LC::D16 << 0.01234567890L << Log::end;
   Log::i() << "bool:" << true << Log::end;
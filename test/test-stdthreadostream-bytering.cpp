@@ -0,0 +1,186 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderStdOstream.h"
+#include "LogQueueStdByteRing.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <array>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Threads log lines "n i text" into a small QueueStdByteRing, where the transient text is
+// 1 to cgMaxTextLength characters long depending on i. The records of varying length wrap the
+// ring many times and reach its end at varying offsets, so it is padded with skip records.
+// Every line must arrive intact and in the order of its thread, and the lines missing must
+// match the lost groups and messages counted in Log::stats().
+// Change cgRingSize or cgMaxTextLength to try other layouts.
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadostream-bytering.cpp -lpthread -o test-stdthreadostream-bytering
+
+constexpr size_t cgThreadCount = 2;
+
+char cgThreadNames[10][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3",
+  "thread_4",
+  "thread_5",
+  "thread_6",
+  "thread_7",
+  "thread_8",
+  "thread_9"
+};
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgAllowRegistrationLog = false;   // Only the checked lines are expected.
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 10u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgRingSize = 512u;              // bytes
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 2;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr nowtech::log::ErrorLevel cgErrorLevel = nowtech::log::ErrorLevel::Error;
+constexpr int32_t cgLineCount = 5000;
+constexpr size_t cgMaxTextLength = 60u;
+constexpr size_t cgTextLengthStep = 7u;          // Coprime to cgMaxTextLength, so all lengths come up.
+constexpr int32_t cgYieldPeriod = 4;
+
+using LogAppInterface = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterface::LogTime cgTimeout = 123u;
+constexpr typename LogAppInterface::LogTime cgRefreshPeriod = 444;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
+using LogQueueStdByteRing = nowtech::log::QueueStdByteRing<LogMessage, LogAppInterface, cgRingSize>;
+using LogAtomicBuffer = nowtech::log::AtomicBufferVoid;
+using LogConfig = nowtech::log::Config<cgAllowRegistrationLog, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod, cgErrorLevel>;
+using Log = nowtech::log::Log<LogQueueStdByteRing, LogSenderStdOstream, LogAtomicBuffer, LogConfig>;
+
+char const cgText[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+static_assert(sizeof(cgText) > cgMaxTextLength);
+
+size_t getTextLength(int32_t const aIndex) {
+  return 1u + (static_cast<size_t>(aIndex) * cgTextLengthStep) % cgMaxTextLength;
+}
+
+/// The number, the index and the chunks of the transient string.
+uint32_t getMessageCount(int32_t const aIndex) {
+  return static_cast<uint32_t>(2u + (getTextLength(aIndex) + cgPayloadSize - 1u) / cgPayloadSize);
+}
+
+void ringLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  char text[cgMaxTextLength + 1u];
+  for(int32_t i = 0; i < cgLineCount; ++i) {
+    size_t const length = getTextLength(i);
+    std::copy(cgText, cgText + length, text);
+    text[length] = 0;
+    Log::n() << static_cast<uint16_t>(n) << i << LC::St << text << Log::end;
+    if(i % cgYieldPeriod == 0) {   // Lets the transmitter pop while the other one pushes, even on a single core.
+      std::this_thread::yield();
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+/// @return true if aLine is the intact line of a thread, logged after its aLastIndices entry.
+/// The messages of the lines skipped since then are added to aMissingMessages.
+bool checkLine(std::string const &aLine, std::array<int32_t, cgThreadCount> &aLastIndices, uint32_t &aMissingMessages) {
+  std::istringstream items(aLine);
+  size_t n = cgThreadCount;
+  int32_t i = -1;
+  std::string text;
+  std::string rest;
+  items >> n >> i >> text;
+  bool result = n < cgThreadCount && i > aLastIndices[n] && i < cgLineCount && text == std::string(cgText, getTextLength(i)) && !(items >> rest);
+  if(result) {
+    for(int32_t missing = aLastIndices[n] + 1; missing < i; ++missing) {
+      aMissingMessages += getMessageCount(missing);
+    }
+    aLastIndices[n] = i;
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+int main() {
+  std::ostringstream output;
+  nowtech::log::LogFormatConfig logConfig;
+  LogSenderStdOstream::init(&output);
+  Log::init(logConfig);
+
+  std::thread threads[cgThreadCount];
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(ringLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+  Log::done();
+
+  std::array<int32_t, cgThreadCount> lastIndices;
+  lastIndices.fill(-1);
+  uint32_t lineCount = 0u;
+  uint32_t missingMessages = 0u;
+  bool intact = true;
+  std::istringstream lines(output.str());
+  std::string line;
+  while(std::getline(lines, line)) {
+    if(checkLine(line, lastIndices, missingMessages)) {
+      ++lineCount;
+    }
+    else {
+      std::cout << "unexpected line: " << line << '\n';
+      intact = false;
+    }
+  }
+  for(auto const last : lastIndices) {
+    for(int32_t missing = last + 1; missing < cgLineCount; ++missing) {
+      missingMessages += getMessageCount(missing);
+    }
+  }
+  auto const stats = Log::stats();
+  uint32_t const missingLines = cgThreadCount * cgLineCount - lineCount;
+  uint32_t const countedLines = stats.total.rejectedGroups + stats.total.discardedGroups;
+  uint32_t const countedMessages = stats.total.rejectedMessages + stats.total.discardedMessages;
+  bool const ok = intact && missingLines == countedLines && missingMessages == countedMessages;
+  std::cout << lineCount << " lines " << (intact ? "intact" : "BROKEN") << ", lost groups: " << missingLines << ", counted: " << countedLines
+            << ", lost messages: " << missingMessages << ", counted: " << countedMessages << (ok ? " ok\n" : " MISMATCH\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderStdOstream.h"
+#include "LogQueueStdCircular.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// A task stalls in the middle of a group, and the otherwise idle transmitter flushes it as
+// "[truncated group of task X ] ..." after the timeout. The rest arriving later is dropped
+// without counting another group. Then a task exceeds its pool quota with a long group, which
+// gets discarded, while its short groups and those of the other task come through. The
+// total losses are printed after each phase, as unregistered TaskIds get reused.
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadostream-eviction.cpp -lpthread -o test-stdthreadostream-eviction
+
+constexpr size_t cgThreadCount = 3;
+
+char cgThreadNames[10][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3",
+  "thread_4",
+  "thread_5",
+  "thread_6",
+  "thread_7",
+  "thread_8",
+  "thread_9"
+};
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgAllowRegistrationLog = true;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 10u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 256u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 444u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 2;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr nowtech::log::ErrorLevel cgErrorLevel = nowtech::log::ErrorLevel::Error;
+constexpr size_t cgTransmitBatchSize = 8u;
+constexpr size_t cgGroupStagingSize = 0u;
+constexpr size_t cgReassemblyInlineSize = 2u;
+constexpr int32_t cgLossReportPeriod = 0;
+constexpr int32_t cgPartialGroupTimeout = 50;
+constexpr size_t cgPoolSoftQuota = 4u;
+constexpr size_t cgPoolHardQuota = 8u;
+constexpr size_t cgPoolReserve = 0u;
+constexpr int32_t cgStallLength = 200;
+constexpr int32_t cgLongGroupLength = 20;
+constexpr int32_t cgShortGroupCount = 5;
+
+using LogAppInterface = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterface::LogTime cgTimeout = 123u;
+constexpr typename LogAppInterface::LogTime cgRefreshPeriod = 444;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
+using LogQueueStdCircular = nowtech::log::QueueStdCircular<LogMessage, LogAppInterface, cgQueueSize>;
+using LogAtomicBuffer = nowtech::log::AtomicBufferVoid;
+using LogConfig = nowtech::log::Config<cgAllowRegistrationLog, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod, cgErrorLevel, cgTransmitBatchSize, cgGroupStagingSize, cgReassemblyInlineSize, cgLossReportPeriod, cgPartialGroupTimeout, cgPoolSoftQuota, cgPoolHardQuota, cgPoolReserve>;
+using Log = nowtech::log::Log<LogQueueStdCircular, LogSenderStdOstream, LogAtomicBuffer, LogConfig>;
+
+void stalledLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  auto chain = Log::n();
+  chain << "stalled group" << 1 << 2 << 3;
+  std::this_thread::sleep_for(std::chrono::milliseconds(cgStallLength));
+  std::cout << "resuming the stalled group\n";
+  chain << 4 << 5 << Log::end;
+  Log::n() << "after the stalled group" << Log::end;
+  Log::unregisterCurrentTask();
+}
+
+void chattyLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgShortGroupCount; ++i) {
+    Log::n() << "chatty short group" << i << Log::end;
+  }
+  auto chain = Log::n();
+  chain << "chatty long group";
+  for(int32_t i = 0; i < cgLongGroupLength; ++i) {
+    chain << i;
+  }
+  chain << Log::end;
+  Log::unregisterCurrentTask();
+}
+
+void quietLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgShortGroupCount; ++i) {
+    Log::n() << "quiet group" << i << 1 << 2 << Log::end;
+  }
+  Log::unregisterCurrentTask();
+}
+
+/// Unregistration waits until the transmitter has processed the messages of the task, so the counters are final.
+void printLosses(char const * const aPhase) {
+  auto const total = Log::stats().total;
+  std::cout << aPhase << " rejected: " << total.rejectedMessages << " messages in " << total.rejectedGroups << " groups, discarded: "
+            << total.discardedMessages << " messages in " << total.discardedGroups << " groups\n";
+}
+
+int main() {
+  nowtech::log::LogFormatConfig logConfig;
+  LogSenderStdOstream::init(&std::cout);
+  Log::init(logConfig);
+  Log::registerCurrentTask("main");
+
+  std::thread stalled(stalledLog, 0u);
+  stalled.join();
+  printLosses("after the stall");
+  std::thread chatty(chattyLog, 1u);
+  std::thread quiet(quietLog, 2u);
+  chatty.join();
+  quiet.join();
+  printLosses("after the long group");
+
+  Log::unregisterCurrentTask();
+  Log::done();
+
+  return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderStdOstream.h"
+#include "LogQueueStdGroup.h"
+#include "LogQueueStdByteRing.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Checks the queues committing whole groups. First the main thread logs groups longer than
+// cgMaxGroupSize, which must be cut there, with the rest counted as rejected in Log::stats().
+// Then several threads flood the queue, and every line must be a whole group "n i 1 2 3 4 5 6"
+// in the order of its thread. The lines missing must match the lost messages counted.
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadostream-group.cpp -lpthread -o test-stdthreadostream-group
+
+constexpr size_t cgThreadCount = 4;
+
+char cgThreadNames[10][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3",
+  "thread_4",
+  "thread_5",
+  "thread_6",
+  "thread_7",
+  "thread_8",
+  "thread_9"
+};
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgAllowRegistrationLog = false;   // Only the checked lines are expected.
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 10u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 200u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 256u;            // Holds all the cut groups at once.
+constexpr size_t cgRingSize = 4096u;            // bytes, the same for QueueStdByteRing
+constexpr size_t cgMaxGroupSize = 16u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 2;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr nowtech::log::ErrorLevel cgErrorLevel = nowtech::log::ErrorLevel::Error;
+constexpr int32_t cgGroupCount = 1000;
+constexpr int32_t cgConstantCount = 6;
+constexpr uint32_t cgGroupLength = 2u + cgConstantCount;   // Messages logged by one floodLog line.
+constexpr int32_t cgYieldPeriod = 16;                      // Less often than the queue would need to keep up.
+constexpr int32_t cgLongGroupCount = 10;
+constexpr int32_t cgLongPrefixCount = 9;                    // Numbers before the string, after the word "cut".
+
+using LogAppInterface = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterface::LogTime cgTimeout = 123u;
+constexpr typename LogAppInterface::LogTime cgRefreshPeriod = 444;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
+using LogQueueStdGroup = nowtech::log::QueueStdGroup<LogMessage, LogAppInterface, cgQueueSize, cgMaxGroupSize>;
+using LogQueueStdByteRing = nowtech::log::QueueStdByteRing<LogMessage, LogAppInterface, cgRingSize, cgMaxGroupSize>;
+using LogAtomicBuffer = nowtech::log::AtomicBufferVoid;
+using LogConfig = nowtech::log::Config<cgAllowRegistrationLog, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod, cgErrorLevel>;
+template<typename tQueue>
+using Log = nowtech::log::Log<tQueue, LogSenderStdOstream, LogAtomicBuffer, LogConfig>;
+
+char const cgLongText[] = "This_text_is_cut_where_the_group_reaches_its_maximal_size,_and_the_rest_of_the_group_is_counted_as_rejected.";
+constexpr uint32_t cgLongChunkCount = (sizeof(cgLongText) - 1u + cgPayloadSize - 1u) / cgPayloadSize;
+constexpr uint32_t cgLongGroupLength = 1u + cgLongPrefixCount + cgLongChunkCount + 1u;   // With the closing '$'.
+constexpr uint32_t cgLongKeptChunkCount = cgMaxGroupSize - 1u - cgLongPrefixCount;
+
+static_assert(cgLongGroupLength > cgMaxGroupSize);
+
+template<typename tLog>
+void floodLog(size_t n) {
+  tLog::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgGroupCount; ++i) {
+    tLog::n() << static_cast<uint16_t>(n) << i << 1 << 2 << 3 << 4 << 5 << 6 << tLog::end;
+    if(i % cgYieldPeriod == 0) {   // Lets the transmitter pop while the others push, even on a single core.
+      std::this_thread::yield();
+    }
+    else { // nothing to do
+    }
+  }
+  tLog::unregisterCurrentTask();
+}
+
+/// @return the line a cut group must give, the string ending with the last kept chunk.
+std::string getCutLine() {
+  std::string result = "cut ";
+  for(int32_t i = 1; i <= cgLongPrefixCount; ++i) {
+    result += std::to_string(i) + ' ';
+  }
+  return result + std::string(cgLongText, cgLongKeptChunkCount * cgPayloadSize) + ' ';
+}
+
+/// @return true if aLine is the whole group of a thread, logged after its aLastIndices entry.
+bool checkLine(std::string const &aLine, std::array<int32_t, cgThreadCount> &aLastIndices) {
+  std::istringstream items(aLine);
+  size_t n = cgThreadCount;
+  int32_t i = -1;
+  items >> n >> i;
+  bool result = n < cgThreadCount && i > aLastIndices[n] && i < cgGroupCount;
+  for(int32_t expected = 1; result && expected <= cgConstantCount; ++expected) {
+    int32_t value = 0;
+    result = (items >> value) && value == expected;
+  }
+  std::string rest;
+  result = result && !(items >> rest);
+  if(result) {
+    aLastIndices[n] = i;
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+template<typename tQueue>
+bool check(char const * const aName) {
+  using tLog = Log<tQueue>;
+  std::ostringstream output;
+  nowtech::log::LogFormatConfig logConfig;
+  LogSenderStdOstream::init(&output);
+  tLog::init(logConfig);
+
+  tLog::registerCurrentTask("main");
+  auto const mainTaskId = LogAppInterface::getCurrentTaskId();
+  for(int32_t i = 0; i < cgLongGroupCount; ++i) {
+    tLog::n() << "cut" << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9 << LC::St << cgLongText << '$' << tLog::end;
+  }
+  std::thread threads[cgThreadCount];
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(floodLog<tLog>, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+  tLog::unregisterCurrentTask();
+  tLog::done();
+
+  std::string const cutLine = getCutLine();
+  std::array<int32_t, cgThreadCount> lastIndices;
+  lastIndices.fill(-1);
+  uint32_t lineCount = 0u;
+  int32_t cutCount = 0;
+  bool whole = true;
+  std::istringstream lines(output.str());
+  std::string line;
+  while(std::getline(lines, line)) {
+    if(line == cutLine) {
+      ++cutCount;
+    }
+    else if(checkLine(line, lastIndices)) {
+      ++lineCount;
+    }
+    else {
+      std::cout << "unexpected line: " << line << '\n';
+      whole = false;
+    }
+  }
+  auto const stats = tLog::stats();
+  auto const &mainStats = stats.tasks[mainTaskId];
+  uint32_t const cut = cgLongGroupCount * (cgLongGroupLength - cgMaxGroupSize);
+  bool const cutOk = cutCount == cgLongGroupCount && mainStats.rejectedMessages == cut && mainStats.rejectedGroups == 0u;
+  uint32_t const lost = (cgThreadCount * cgGroupCount - lineCount) * cgGroupLength;
+  uint32_t const counted = stats.total.rejectedMessages + stats.total.discardedMessages - mainStats.rejectedMessages;
+  std::cout << aName << ": " << cutCount << " cut lines, cut messages: " << cut << ", counted: " << mainStats.rejectedMessages << (cutOk ? " ok" : " MISMATCH")
+            << ", " << lineCount << " whole lines " << (whole ? "in order" : "BROKEN") << ", lost messages: " << lost
+            << ", counted: " << counted << (lost == counted ? " ok\n" : " MISMATCH\n");
+  return cutOk && whole && lost == counted;
+}
+
+int main() {
+  bool ok = check<LogQueueStdGroup>("QueueStdGroup");
+  ok = check<LogQueueStdByteRing>("QueueStdByteRing") && ok;
+  return ok ? 0 : 1;
+}
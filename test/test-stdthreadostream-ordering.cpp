@@ -0,0 +1,169 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderStdOstream.h"
+#include "LogQueueStdCircular.h"
+#include "LogQueueStdMpsc.h"
+#include "LogQueueStdPerTask.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <array>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Several threads log numbered groups at once through each queue whose groups the transmitter
+// reassembles per task. Every line must be a whole group "n i 1 2 3 4 5 6", and the numbers i of
+// each thread must increase. The lines missing must match the lost messages counted in Log::stats().
+// Decrease cgQueueSize to see losses.
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadostream-ordering.cpp -lpthread -o test-stdthreadostream-ordering
+
+constexpr size_t cgThreadCount = 4;
+
+char cgThreadNames[10][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3",
+  "thread_4",
+  "thread_5",
+  "thread_6",
+  "thread_7",
+  "thread_8",
+  "thread_9"
+};
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgAllowRegistrationLog = false;   // Only the numbered lines are expected.
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 10u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 444u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 2;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr nowtech::log::ErrorLevel cgErrorLevel = nowtech::log::ErrorLevel::Error;
+constexpr int32_t cgGroupCount = 1000;
+constexpr int32_t cgConstantCount = 6;
+constexpr uint32_t cgGroupLength = 2u + cgConstantCount;   // Messages logged by one orderedLog line.
+
+using LogAppInterface = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterface::LogTime cgTimeout = 123u;
+constexpr typename LogAppInterface::LogTime cgRefreshPeriod = 444;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
+using LogQueueStdCircular = nowtech::log::QueueStdCircular<LogMessage, LogAppInterface, cgQueueSize>;
+using LogQueueStdMpsc = nowtech::log::QueueStdMpsc<LogMessage, LogAppInterface, cgQueueSize>;
+using LogQueueStdPerTask = nowtech::log::QueueStdPerTask<LogMessage, LogAppInterface, cgQueueSize>;
+using LogAtomicBuffer = nowtech::log::AtomicBufferVoid;
+using LogConfig = nowtech::log::Config<cgAllowRegistrationLog, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod, cgErrorLevel>;
+template<typename tQueue>
+using Log = nowtech::log::Log<tQueue, LogSenderStdOstream, LogAtomicBuffer, LogConfig>;
+
+template<typename tLog>
+void orderedLog(size_t n) {
+  tLog::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgGroupCount; ++i) {
+    tLog::n() << static_cast<uint16_t>(n) << i << 1 << 2 << 3 << 4 << 5 << 6 << tLog::end;
+    std::this_thread::yield();   // Lets the transmitter keep up even on a single core, so the threads interleave.
+  }
+  tLog::unregisterCurrentTask();
+}
+
+/// @return true if aLine is the whole group of a thread, logged after its aLastIndices entry.
+bool checkLine(std::string const &aLine, std::array<int32_t, cgThreadCount> &aLastIndices) {
+  std::istringstream items(aLine);
+  size_t n = cgThreadCount;
+  int32_t i = -1;
+  items >> n >> i;
+  bool result = n < cgThreadCount && i > aLastIndices[n] && i < cgGroupCount;
+  for(int32_t expected = 1; result && expected <= cgConstantCount; ++expected) {
+    int32_t value = 0;
+    result = (items >> value) && value == expected;
+  }
+  std::string rest;
+  result = result && !(items >> rest);
+  if(result) {
+    aLastIndices[n] = i;
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+template<typename tQueue>
+bool check(char const * const aName) {
+  using tLog = Log<tQueue>;
+  std::ostringstream output;
+  nowtech::log::LogFormatConfig logConfig;
+  LogSenderStdOstream::init(&output);
+  tLog::init(logConfig);
+
+  std::thread threads[cgThreadCount];
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(orderedLog<tLog>, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+  tLog::done();
+
+  std::array<int32_t, cgThreadCount> lastIndices;
+  lastIndices.fill(-1);
+  uint32_t lineCount = 0u;
+  bool ordered = true;
+  std::istringstream lines(output.str());
+  std::string line;
+  while(std::getline(lines, line)) {
+    if(checkLine(line, lastIndices)) {
+      ++lineCount;
+    }
+    else {
+      std::cout << "unexpected line: " << line << '\n';
+      ordered = false;
+    }
+  }
+  auto const stats = tLog::stats();
+  uint32_t const lost = (cgThreadCount * cgGroupCount - lineCount) * cgGroupLength;
+  uint32_t const counted = stats.total.rejectedMessages + stats.total.discardedMessages;
+  std::cout << aName << ": " << lineCount << " lines " << (ordered ? "in order" : "OUT OF ORDER") << ", lost messages: " << lost
+            << ", counted: " << counted << (lost == counted ? " ok\n" : " MISMATCH\n");
+  return ordered && lost == counted;
+}
+
+int main() {
+  bool ok = check<LogQueueStdPerTask>("QueueStdPerTask");
+  ok = check<LogQueueStdMpsc>("QueueStdMpsc") && ok;
+  ok = check<LogQueueStdCircular>("QueueStdCircular") && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderStdOstream.h"
+#include "LogQueueStdCircular.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <cctype>
+#include <iostream>
+#include <thread>
+
+// Floods a small queue from several threads. Whatever gets through must consist of
+// whole lines "n: i 1 2 3 4 5" only, besides the "[N groups lost on task X]" reports.
+// The lost messages counted in Log::stats() must make up for the missing lines.
+// Change cgOverflowAction or cgGroupStagingSize to try the other policies.
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadostream-overflow.cpp -lpthread -o test-stdthreadostream-overflow
+
+constexpr size_t cgThreadCount = 4;
+
+char cgThreadNames[10][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3",
+  "thread_4",
+  "thread_5",
+  "thread_6",
+  "thread_7",
+  "thread_8",
+  "thread_9"
+};
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgAllowRegistrationLog = false;   // Their groups would be lost as well.
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 10u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 64u;
+constexpr nowtech::log::OverflowAction cgOverflowAction = nowtech::log::OverflowAction::cRejectGroup;
+constexpr uint32_t cgBlockTimeout = 10u;
+constexpr size_t cgGroupHeadroom = 8u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 2;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr nowtech::log::ErrorLevel cgErrorLevel = nowtech::log::ErrorLevel::Error;
+constexpr size_t cgTransmitBatchSize = 8u;
+constexpr size_t cgGroupStagingSize = 0u;
+constexpr size_t cgReassemblyInlineSize = 8u;
+constexpr int32_t cgLossReportPeriod = 100;
+constexpr int32_t cgGroupCount = 100;
+constexpr uint32_t cgGroupLength = 8u;   // Messages logged by one floodLog line.
+
+using LogAppInterface = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterface::LogTime cgTimeout = 123u;
+constexpr typename LogAppInterface::LogTime cgRefreshPeriod = 444;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterface, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
+using LogOverflowPolicy = nowtech::log::OverflowPolicy<cgOverflowAction, cgBlockTimeout, cgGroupHeadroom>;
+using LogQueueStdCircular = nowtech::log::QueueStdCircular<LogMessage, LogAppInterface, cgQueueSize, LogOverflowPolicy>;
+using LogAtomicBuffer = nowtech::log::AtomicBufferVoid;
+using LogConfig = nowtech::log::Config<cgAllowRegistrationLog, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod, cgErrorLevel, cgTransmitBatchSize, cgGroupStagingSize, cgReassemblyInlineSize, cgLossReportPeriod>;
+using Log = nowtech::log::Log<LogQueueStdCircular, LogSenderStdOstream, LogAtomicBuffer, LogConfig>;
+
+void floodLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgGroupCount; ++i) {
+    Log::n() << static_cast<uint16_t>(n) << ": " << i << 1 << 2 << 3 << 4 << 5 << Log::end;
+  }
+  Log::unregisterCurrentTask();
+}
+
+/// Passes everything to the buffer of std::cout and counts the lines starting with a digit.
+class LineCountingBuffer final : public std::streambuf {
+  std::streambuf *mTarget;
+  uint32_t        mLines = 0u;
+  bool            mLineStart = true;
+
+public:
+  LineCountingBuffer(std::streambuf * const aTarget) : mTarget(aTarget) {
+  }
+
+  uint32_t getLines() const {
+    return mLines;
+  }
+
+protected:
+  std::streamsize xsputn(char const * const aData, std::streamsize const aCount) override {
+    for(std::streamsize i = 0; i < aCount; ++i) {
+      count(aData[i]);
+    }
+    return mTarget->sputn(aData, aCount);
+  }
+
+  int_type overflow(int_type const aCharacter) override {
+    count(traits_type::to_char_type(aCharacter));
+    return mTarget->sputc(traits_type::to_char_type(aCharacter));
+  }
+
+private:
+  void count(char const aCharacter) {
+    if(mLineStart && std::isdigit(static_cast<unsigned char>(aCharacter))) {
+      ++mLines;
+    }
+    else { // nothing to do
+    }
+    mLineStart = (aCharacter == '\n');
+  }
+};
+
+int main() {
+  std::thread threads[cgThreadCount + 1u]; // let there be zero threads
+
+  nowtech::log::LogFormatConfig logConfig;
+  LineCountingBuffer countingBuffer(std::cout.rdbuf());
+  std::ostream countingStream(&countingBuffer);
+  LogSenderStdOstream::init(&countingStream);
+  Log::init(logConfig);
+  Log::registerCurrentTask("main");
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(floodLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  Log::unregisterCurrentTask();
+  Log::done();
+
+  auto const stats = Log::stats();
+  std::cout << "rejected: " << stats.total.rejectedMessages << " messages in " << stats.total.rejectedGroups << " groups, discarded: "
+            << stats.total.discardedMessages << " messages in " << stats.total.discardedGroups << " groups\n";
+  if constexpr(cgOverflowAction != nowtech::log::OverflowAction::cDropOldest) {   // Evicted messages are not counted.
+    uint32_t const lost = (cgThreadCount * cgGroupCount - countingBuffer.getLines()) * cgGroupLength;
+    uint32_t const counted = stats.total.rejectedMessages + stats.total.discardedMessages;
+    std::cout << "lost messages: " << lost << ", counted: " << counted << (lost == counted ? " ok\n" : " MISMATCH\n");
+  }
+  else { // nothing to do
+  }
+  return 0;
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogMessageCompact.h"
+#include "LogConverterCustomText.h"
+#include "LogConverterBinary.h"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Renders the records of ConverterBinary from the standard input into the text layout
+// of ConverterCustomText on the standard output. The settings below must match the
+// ConverterCustomText the application would use for text output.
+// clang++ -std=c++20 -O2 -Isrc tools/log-decode-binary.cpp -o log-decode-binary
+// ./test-stdthreadostream-binary | ./log-decode-binary
+// Ids of the string id mode sent before the decoder joined are printed as <string id>.
+
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr bool cgShortestFloat = true;
+constexpr bool cgIntegerFloat = false;
+constexpr size_t cgPayloadSize = 8u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgLineBufferSize = 1u << 16u;
+
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned, cgShortestFloat, cgIntegerFloat>;
+using LogConverterBinary = nowtech::log::ConverterBinary<LogMessage>;
+using nowtech::log::BinaryTag;
+
+class Decoder final {
+  std::vector<uint8_t> const &mInput;
+  size_t                      mPosition = 0u;
+  uint64_t                    mLastTimestamp = 0u;
+  bool                        mTimestampKnown = false;
+  std::vector<char>           mLine;
+  std::unordered_map<uint64_t, std::string> mStrings;   // Definitions of the string id mode.
+
+public:
+  Decoder(std::vector<uint8_t> const &aInput) : mInput(aInput), mLine(cgLineBufferSize) {
+  }
+
+  /// @return false on malformed input, which may also be a truncated record at the end.
+  bool run() {
+    bool result = true;
+    while(result && mPosition < mInput.size()) {
+      LogConverterCustomText converter(mLine.data(), mLine.data() + mLine.size() - 1u);
+      bool endOfLine = false;
+      while(result && !endOfLine && mPosition < mInput.size()) {
+        result = decode(converter, endOfLine);
+      }
+      if(endOfLine) {
+        converter.terminateSequence();
+      }
+      else { // nothing to do
+      }
+      std::cout.write(mLine.data(), converter.end() - mLine.data());
+    }
+    return result;
+  }
+
+private:
+  bool readByte(uint8_t &aByte) {
+    bool result = mPosition < mInput.size();
+    if(result) {
+      aByte = mInput[mPosition];
+      ++mPosition;
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  bool readVarint(uint64_t &aValue) {
+    aValue = 0u;
+    uint8_t byte = 0u;
+    bool result = true;
+    for(uint32_t shift = 0u; result && shift < 64u; shift += 7u) {
+      result = readByte(byte);
+      aValue |= static_cast<uint64_t>(byte & 0x7fu) << shift;
+      if((byte & 0x80u) == 0u) {
+        break;
+      }
+      else { // nothing to do
+      }
+    }
+    return result && (byte & 0x80u) == 0u;
+  }
+
+  bool readBits(uint64_t &aBits, size_t const aByteCount) {
+    aBits = 0u;
+    bool result = true;
+    for(size_t i = 0u; result && i < aByteCount; ++i) {
+      uint8_t byte = 0u;
+      result = readByte(byte);
+      aBits |= static_cast<uint64_t>(byte) << (8u * i);
+    }
+    return result;
+  }
+
+  static int64_t unzigzag(uint64_t const aValue) {
+    return static_cast<int64_t>(aValue >> 1u) ^ -static_cast<int64_t>(aValue & 1u);
+  }
+
+  bool decode(LogConverterCustomText &aConverter, bool &aEndOfLine) {
+    uint8_t tagByte = 0u;
+    bool result = readByte(tagByte);
+    uint8_t base = LogConverterBinary::csDefaultBase;
+    uint8_t fill = 0u;
+    if(result && (tagByte & LogConverterBinary::csFormatFollows) != 0u) {
+      result = readByte(base) && readByte(fill);
+    }
+    else { // nothing to do
+    }
+    BinaryTag const tag = static_cast<BinaryTag>(tagByte & LogConverterBinary::csTagMask);
+    uint64_t value = 0u;
+    if(!result) { // nothing to do
+    }
+    else if(tag == BinaryTag::cEndOfLine) {
+      aEndOfLine = true;
+    }
+    else if(tag == BinaryTag::cUnsigned) {
+      result = readVarint(value);
+      aConverter.convert(value, base, fill);
+    }
+    else if(tag == BinaryTag::cSigned) {
+      result = readVarint(value);
+      aConverter.convert(unzigzag(value), base, fill);
+    }
+    else if(tag == BinaryTag::cFloat) {
+      result = readBits(value, sizeof(float));
+      uint32_t const bits = static_cast<uint32_t>(value);
+      float number;
+      std::memcpy(&number, &bits, sizeof(number));
+      aConverter.convert(number, base, fill);
+    }
+    else if(tag == BinaryTag::cDouble) {
+      result = readBits(value, sizeof(double));
+      double number;
+      std::memcpy(&number, &value, sizeof(number));
+      aConverter.convert(number, base, fill);
+    }
+    else if(tag == BinaryTag::cChar) {
+      uint8_t character = 0u;
+      result = readByte(character);
+      aConverter.convert(static_cast<char>(character), base, fill);
+    }
+    else if(tag == BinaryTag::cString || tag == BinaryTag::cStringChunk) {
+      result = readVarint(value) && value <= mInput.size() - mPosition;
+      if(result) {
+        std::string const text(reinterpret_cast<char const*>(mInput.data() + mPosition), value);
+        mPosition += value;
+        aConverter.convert(text.c_str(), tag == BinaryTag::cString ? uint8_t{0u} : nowtech::log::LogFormat::csFillValueStoreString);
+      }
+      else { // nothing to do
+      }
+    }
+    else if(tag == BinaryTag::cStringDefine) {
+      uint64_t id = 0u;
+      result = readVarint(id) && readVarint(value) && value <= mInput.size() - mPosition;
+      if(result) {
+        std::string &text = mStrings[id];
+        text.assign(reinterpret_cast<char const*>(mInput.data() + mPosition), value);
+        mPosition += value;
+        aConverter.convert(text.c_str(), uint8_t{0u});
+      }
+      else { // nothing to do
+      }
+    }
+    else if(tag == BinaryTag::cStringId) {
+      result = readVarint(value);
+      auto const found = mStrings.find(value);
+      if(found != mStrings.end()) {
+        aConverter.convert(found->second.c_str(), uint8_t{0u});
+      }
+      else {   // Joined a running stream after the definition.
+        std::string const text = "<string " + std::to_string(value) + '>';
+        aConverter.convert(text.c_str(), uint8_t{0u});
+      }
+    }
+    else if(tag == BinaryTag::cFalse || tag == BinaryTag::cTrue) {
+      aConverter.convert(tag == BinaryTag::cTrue, base, fill);
+    }
+    else if(tag == BinaryTag::cTimestamp) {
+      result = readVarint(mLastTimestamp);
+      mTimestampKnown = true;
+      aConverter.convert(mLastTimestamp, base, fill);
+    }
+    else if(tag == BinaryTag::cTimestampDelta) {
+      result = readVarint(value);
+      mLastTimestamp += static_cast<uint64_t>(unzigzag(value));
+      if(mTimestampKnown) {
+        aConverter.convert(mLastTimestamp, base, fill);
+      }
+      else {   // Joined a running stream, the time is unknown until the next absolute one.
+        aConverter.convert('?', base, fill);
+      }
+    }
+    else {
+      std::cerr << "unknown tag " << static_cast<int>(tagByte) << " at " << (mPosition - 1u) << '\n';
+      result = false;
+    }
+    return result;
+  }
+};
+
+int main() {
+  std::vector<uint8_t> input;
+  char buffer[1u << 12u];
+  size_t count;
+  while((count = std::fread(buffer, 1u, sizeof(buffer), stdin)) > 0u) {
+    input.insert(input.end(), buffer, buffer + count);
+  }
+  Decoder decoder(input);
+  bool const result = decoder.run();
+  if(!result) {
+    std::cerr << "malformed or truncated input\n";
+  }
+  else { // nothing to do
+  }
+  return result ? 0 : 1;
+}